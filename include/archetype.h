@@ -0,0 +1,14 @@
+#ifndef ARCHETYPE_H
+#define ARCHETYPE_H
+
+#include <cstdint>
+
+// Every kind of item there is.  See Archetype in item.h.
+enum class ARCHETYPE : std::uint8_t { NOTHING = 0, DOOR, TRAP,
+    VAMPIRE_BAT, GIANT_RAT, ZOMBIE, KOBOLD,
+    HOBGOBLIN, ORC, GIANT_SPIDER, GELATINOUS_CUBE,
+    LIZARD_MAN, NAGA, TROLL, MINOTAUR, WIZARD, FLOATING_EYE, DRAGON,
+    HEALING_POTION, KEY, BUCKLER, SHIELD, SWORD, BATTLEAXE, COUNT
+};
+
+#endif // ARCHETYPE_H
@@ -0,0 +1,32 @@
+#ifndef BITLAYER_H
+#define BITLAYER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A resizable array of bits packed 64 to a word.  Bit i is bit i % 64 of
+// word i / 64, so a map stored row by row can be worked on a word at a time.
+class BitLayer {
+public:
+    BitLayer();
+    ~BitLayer()=default;
+    void          assign(std::size_t size, bool value);
+    void          fill(bool value);
+    void          fill(std::size_t first, std::size_t count, bool value);
+    std::size_t   size() const;
+    bool          test(std::size_t i) const;
+    void          set(std::size_t i, bool value);
+    std::uint64_t word(std::size_t w) const;
+
+    // Copies count bits starting at first into out, starting at bit 0 of
+    // out[0].  The rest of the last word written is cleared.
+    void          copy(std::size_t first, std::size_t count,
+                      std::uint64_t* out) const;
+
+private:
+    std::vector<std::uint64_t> words_;
+    std::size_t                size_;
+};
+
+#endif // BITLAYER_H
@@ -0,0 +1,61 @@
+#ifndef CHUNKSTORE_H
+#define CHUNKSTORE_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include "entities.h"
+#include "tile.h"
+
+class ItemGrid;
+class TileStore;
+
+// Chunks are CHUNKSIZE x CHUNKSIZE tiles.
+constexpr int CHUNKSIZE = 64;
+
+// What a ChunkStore has done so far.  Misses are chunks which had to be
+// generated or restored; spills are evictions which had to be written out.
+struct ChunkStats {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+    unsigned long spills;
+    unsigned long restores;
+    std::size_t   resident;
+    std::size_t   bytes;
+};
+
+// Holds a map as square chunks which are generated the first time they are
+// touched.  When the chunks in memory add up to more than the budget, the
+// least recently used are dropped.  Chunks which have changed since they
+// were generated are written to a temporary file first and read back from
+// it the next time they are needed.  Changes through insert(), remove() and
+// touch() mark a chunk as changed.  The items on a chunk are entities in the
+// store given to assign(); they are destroyed when their chunk is dropped
+// and created again when it is restored.
+class ChunkStore {
+public:
+    using Generator = std::function<void(int chunkRow, int chunkCol,
+        TileStore& tiles, ItemGrid& items)>;
+
+    ChunkStore();
+    ~ChunkStore();
+    void       assign(int height, int width, std::size_t budget,
+                   Entities& entities, Generator generate);
+    void       clear();
+    Tile       tileAt(int row, int col);
+    Entity     itemAt(int row, int col);
+    Entity     insert(int row, int col, Entity entity);
+    Entity     remove(int row, int col);
+    void       touch(int row, int col);
+    void       foreach(int top, int left, int height, int width,
+                   std::function<void(int, int, Entity)> callback);
+    void       setAllVisible(bool visible);
+    ChunkStats stats() const;
+
+private:
+    struct ChunkStoreImpl;
+    std::unique_ptr<ChunkStoreImpl> impl_;
+};
+
+#endif // CHUNKSTORE_H
@@ -1,16 +1,18 @@
 #ifndef COMBAT_H
 #define COMBAT_H
 
-#include <memory>
+#include <cstdint>
 
+class Random;
+
+// A monster's combat component (see Entities) and the player's own stats.
 class Combat
 {
 public:
     Combat();
     Combat(int health, int offense, int defense);
-    virtual ~Combat();
-    int  attack();
-    int  defend();
+    int  attack(Random& rng);
+    int  defend(Random& rng);
     int  defense() const;
     void setDefense(int defense);
     int  health() const;
@@ -19,8 +21,9 @@ public:
     void setOffense(int offense);
 
 private:
-    struct CombatImpl;
-    std::unique_ptr<CombatImpl> impl_;
+    std::int16_t health_;
+    std::int16_t offense_;
+    std::int16_t defense_;
 };
 
 #endif // COMBAT_H
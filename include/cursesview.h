@@ -0,0 +1,48 @@
+#ifndef CURSESVIEW_H
+#define CURSESVIEW_H
+
+#include <memory>
+#include <string>
+
+#include "scheduler.h"
+#include "view.h"
+
+// What drawing has cost: cells changed and bytes written to the terminal,
+// for the last frame drawn and in all.  Frames in which nothing on screen
+// changed are skipped without touching the terminal.  Bytes are counted
+// from /proc/self/io, so only on Linux.
+struct FrameStats {
+    unsigned long frames;
+    unsigned long skipped;
+    unsigned long cells;
+    unsigned long bytes;
+    unsigned long lastCells;
+    unsigned long lastBytes;
+};
+
+class CursesView : public View {
+public:
+    CursesView();
+    virtual ~CursesView();
+    void  alert() override;
+    STATE draw(World& world, Player& player) override;
+    void  end() override;
+    STATE handleTopLevelInput(Game* game) override;
+    DIRECTION handleDirectionInput(Game* game) override;
+    int   handleNumericalInput(Game* game) override;
+    bool  handleBooleanInput(Game* game) override;
+    void  init(std::string titleText) override;
+    void  message(std::string_view msg) override;
+    void  pause(Game* game) override;
+    void  refresh() override;
+    void  resize(World& world) override;
+    void  shell() override;
+    FrameStats frameStats() const;
+    SchedulerStats schedulerStats() const;
+    void  setRates(unsigned ticksPerSecond, unsigned framesPerSecond);
+private:
+    struct ViewImpl;
+    std::unique_ptr<ViewImpl> impl_;
+};
+
+#endif // CURSESVIEW_H
@@ -0,0 +1,160 @@
+#ifndef ENTITIES_H
+#define ENTITIES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "archetype.h"
+#include "armament.h"
+#include "combat.h"
+
+typedef std::uint32_t Entity;
+
+constexpr Entity NO_ENTITY = UINT32_MAX;
+
+// Where an entity is on the map.  Carried items have none.
+struct Position {
+    int row;
+    int col;
+};
+
+struct DoorState {
+    bool horizontal;
+    bool open;
+};
+
+struct TrapState {
+    bool sprung;
+};
+
+// An awake monster: when it is next due to act, how long its actions take
+// and which of its entries in the turn queue is the live one.
+struct Actor {
+    std::uint64_t due;
+    std::uint32_t ticket;
+    std::uint32_t delay;
+};
+
+// The components of one kind, packed together in values_ so a system can go
+// through them as an array.  sparse_ maps an entity to where its component
+// is and entities_ maps back the other way, so adding, finding and removing
+// a component all take constant time.  Removing one moves the last into its
+// place, so the order changes.
+template<typename T>
+class SparseSet {
+public:
+    SparseSet() : sparse_{}, entities_{}, values_{} {}
+
+    bool has(Entity entity) const {
+        return entity < sparse_.size() && sparse_[entity] != NO_ENTITY;
+    }
+
+    T* find(Entity entity) {
+        return has(entity) ? &values_[sparse_[entity]] : nullptr;
+    }
+
+    const T* find(Entity entity) const {
+        return has(entity) ? &values_[sparse_[entity]] : nullptr;
+    }
+
+    T& insert(Entity entity, const T& value) {
+        if (has(entity)) {
+            return values_[sparse_[entity]] = value;
+        }
+        if (entity >= sparse_.size()) {
+            sparse_.resize(static_cast<std::size_t>(entity) + 1, NO_ENTITY);
+        }
+        sparse_[entity] = static_cast<Entity>(values_.size());
+        entities_.push_back(entity);
+        values_.push_back(value);
+        return values_.back();
+    }
+
+    void erase(Entity entity) {
+        if (!has(entity)) {
+            return;
+        }
+        Entity i = sparse_[entity];
+        sparse_[entities_.back()] = i;
+        entities_[i] = entities_.back();
+        values_[i] = values_.back();
+        entities_.pop_back();
+        values_.pop_back();
+        sparse_[entity] = NO_ENTITY;
+    }
+
+    void clear() {
+        sparse_.clear();
+        entities_.clear();
+        values_.clear();
+    }
+
+    std::size_t size() const {
+        return values_.size();
+    }
+
+    std::size_t bytes() const {
+        return sparse_.capacity() * sizeof(Entity) +
+            entities_.capacity() * sizeof(Entity) +
+            values_.capacity() * sizeof(T);
+    }
+
+    const std::vector<Entity>& entities() const {
+        return entities_;
+    }
+
+    std::vector<T>& values() {
+        return values_;
+    }
+
+    const std::vector<T>& values() const {
+        return values_;
+    }
+
+private:
+    std::vector<Entity> sparse_;
+    std::vector<Entity> entities_;
+    std::vector<T>      values_;
+};
+
+// Every monster, item, door and trap in a world.  An entity is just a
+// number; its archetype is kept in an array indexed by it and the rest of
+// what there is to know about it in a SparseSet for each component.  The
+// numbers of destroyed entities are handed out again by create().
+class Entities {
+public:
+    Entities();
+    ~Entities()=default;
+    Entity      create(ARCHETYPE archetype);
+    void        destroy(Entity entity);
+    void        clear();
+    bool        alive(Entity entity) const;
+    ARCHETYPE   archetype(Entity entity) const;
+    std::size_t size() const;
+    std::size_t bytes() const;
+
+    SparseSet<Actor>&           actors();
+    const SparseSet<Actor>&     actors() const;
+    SparseSet<Armament>&        armaments();
+    const SparseSet<Armament>&  armaments() const;
+    SparseSet<Combat>&          combat();
+    const SparseSet<Combat>&    combat() const;
+    SparseSet<DoorState>&       doors();
+    const SparseSet<DoorState>& doors() const;
+    SparseSet<Position>&        positions();
+    const SparseSet<Position>&  positions() const;
+    SparseSet<TrapState>&       traps();
+    const SparseSet<TrapState>& traps() const;
+
+private:
+    std::vector<ARCHETYPE> archetypes_;
+    std::vector<Entity>    free_;
+    SparseSet<Actor>       actors_;
+    SparseSet<Armament>    armaments_;
+    SparseSet<Combat>      combat_;
+    SparseSet<DoorState>   doors_;
+    SparseSet<Position>    positions_;
+    SparseSet<TrapState>   traps_;
+};
+
+#endif // ENTITIES_H
@@ -0,0 +1,97 @@
+#ifndef FIGHT_H
+#define FIGHT_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "archetype.h"
+#include "combat.h"
+#include "itemtype.h"
+
+class Random;
+
+// Every attack is 2d6 plus the attacker's offense against 2d6 plus the
+// defender's defense, and hits if it comes out higher.  Of the ROLLS ways
+// the four dice can fall, DIFFERENCES[d + 10] have the first pair coming out
+// d more than the second.
+constexpr int ROLLS = 6 * 6 * 6 * 6;
+
+constexpr std::array<int, 21> differences() {
+    std::array<int, 21> counts{};
+    for (int a = 1; a <= 6; a++) {
+        for (int b = 1; b <= 6; b++) {
+            for (int c = 1; c <= 6; c++) {
+                for (int d = 1; d <= 6; d++) {
+                    counts[a + b - c - d + 10]++;
+                }
+            }
+        }
+    }
+    return counts;
+}
+
+constexpr std::array<int, 21> DIFFERENCES = differences();
+
+// How many of the ROLLS ways an attack with offense hits a defense.
+constexpr int hits(int offense, int defense) {
+    int ways = 0;
+    for (int d = std::max(defense - offense + 1, -10); d <= 10; d++) {
+        ways += DIFFERENCES[d + 10];
+    }
+    return ways;
+}
+
+static_assert(hits(0, 0) == (ROLLS - 146) / 2, "2d6 against 2d6 is wrong");
+
+// The two sides of a fight.  Each hit by the monster costs the player damage
+// health; if it teleports, a hit also sends the player back to the start and
+// so ends the fight.  The player always gets their swing in the same round.
+struct Bout {
+    int  playerHealth;
+    int  playerOffense;
+    int  playerDefense;
+    int  monsterHealth;
+    int  monsterOffense;
+    int  monsterDefense;
+    int  damage;
+    bool teleports;
+};
+
+// How a fight to the death can end.  In a stalemate neither side can ever
+// hit the other, so it is called off after a round.
+enum class ENDING : std::uint8_t { WON, LOST, BOTH, TELEPORTED, STALEMATE,
+    COUNT };
+
+// How one fight to the death went.  Taken and dealt are the hits each way.
+struct Fight {
+    ENDING        ending;
+    unsigned long rounds;
+    int           taken;
+    int           dealt;
+};
+
+// The exact chance of each ENDING, and how much health the player can
+// expect to lose and how many rounds it can expect to last.
+struct Odds {
+    std::array<double, static_cast<std::size_t>(ENDING::COUNT)> endings;
+    double damage;
+    double rounds;
+};
+
+// A kind of monster against the player wielding a pair of things, either of
+// which can be NOTHING.
+struct Matchup {
+    ARCHETYPE                monster;
+    std::array<ARCHETYPE, 2> wielded;
+    Odds                     odds;
+};
+
+Bout  bout(const Combat& player, int offenseBonus, int defenseBonus,
+          const Combat& monster, ITEMTYPE type);
+Odds  odds(const Bout& bout);
+Fight fight(const Bout& bout, Random& rng);
+std::vector<Matchup> matchups(const Combat& player);
+
+#endif // FIGHT_H
@@ -1,16 +1,33 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "maze.h"
 #include "state.h"
 
+class View;
+
 class Game {
 public:
-    Game()=default;
-    ~Game()=default;
+    explicit Game(std::unique_ptr<View> view);
+    ~Game();
     int run(const char *name, const char *version);
+    unsigned long turns() const;
+    unsigned long ticks() const;
+    std::uint64_t seed() const;
+    void setSeed(std::uint64_t seed);
+    void setWorldSize(int height, int width);
+    void setMaze(MAZE maze);
+    void setEndless(bool endless);
+    void setChunkBudget(std::size_t bytes);
+    void setFovRadius(int radius);
+    void setHunting(bool hunting);
     STATE badInput();
     STATE dead();
     void  draw();
+    void  tick();
     STATE error();
     STATE fight();
     STATE fightToDeath();
@@ -32,6 +49,10 @@ public:
     STATE run_downright();
     STATE moveOver();
     STATE runOver();
+    STATE explore();
+    STATE travelToStart();
+    STATE travelToExit();
+    STATE travelToDoor();
     STATE batter();
     STATE open();
     STATE close();
@@ -47,7 +68,7 @@ public:
     STATE version();
 private:
     struct GameImpl;
-    static GameImpl impl_;
+    std::unique_ptr<GameImpl> impl_;
 };
 
 #endif // GAME_H
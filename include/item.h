@@ -1,28 +1,62 @@
 #ifndef ITEM_H
 #define ITEM_H
 
-#include <memory>
-#include <string>
+#include <cstdint>
+#include <string_view>
+#include "archetype.h"
+#include "entities.h"
 #include "itemtype.h"
 
+// Archetype flags.
+constexpr std::uint8_t MONSTER   = 1 << 0;
+constexpr std::uint8_t TAKEABLE  = 1 << 1;
+constexpr std::uint8_t WIELDABLE = 1 << 2;
+
+// What every item of a kind has in common.  There is one of these for each
+// ARCHETYPE and items only refer to it, so an item holds no more than what
+// can change about it.  Offense and defense are a monster's own or what an
+// armament adds to the player's.  Speed is how fast a monster acts, as a
+// percentage of the player's; 0 means it stays where it is.
+struct Archetype {
+    std::string_view article;
+    std::string_view name;
+    ITEMTYPE         type;
+    char             glyph;
+    std::int8_t      health;
+    std::int8_t      offense;
+    std::int8_t      defense;
+    std::uint8_t     speed;
+    std::uint8_t     flags;
+};
+
+const Archetype& archetype(ARCHETYPE id);
+
+// A handle on an entity in an Entities store.  What the item is comes from
+// its archetype and the state of it from its components, which are nullptr
+// if it doesn't have them.  A default constructed Item is no item at all.
 class Item
 {
 public:
     Item();
-    Item(std::string article, std::string name, ITEMTYPE type);
-     virtual ~Item();
-     std::string article() const;
-     void        setArticle(std::string article);
-     std::string name() const;
-     void        setName(std::string name);
-     ITEMTYPE    type() const;
-     void        setType(ITEMTYPE type);
+    Item(Entities* entities, Entity entity);
+    Item(const Item&)=default;
+    Item& operator=(const Item&)=default;
+    ~Item()=default;
+    explicit operator bool() const;
+    Entity           entity() const;
+    const Archetype& archetype() const;
+    ARCHETYPE        archetypeId() const;
+    std::string_view article() const;
+    std::string_view name() const;
+    ITEMTYPE         type() const;
+    Armament*        armament() const;
+    Combat*          combat() const;
+    DoorState*       door() const;
+    TrapState*       trap() const;
 
- private:
-    struct ItemImpl;
-    std::unique_ptr<ItemImpl> impl_;
+private:
+    Entities* entities_;
+    Entity    entity_;
 };
 
-typedef std::unique_ptr<Item> ITEMPTR;
-
 #endif // ITEM_H
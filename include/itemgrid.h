@@ -0,0 +1,44 @@
+#ifndef ITEMGRID_H
+#define ITEMGRID_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "entities.h"
+
+// A spatial index of the entities on a map.  The map is divided into square
+// buckets; each bucket has an occupancy bitmask and keeps its items packed in
+// slot order, so finding the item at a position is a popcount and a rectangle
+// query only visits the items inside the rectangle.  Empty places give
+// NO_ENTITY.
+class ItemGrid {
+public:
+    ItemGrid();
+    ~ItemGrid()=default;
+    void        assign(int height, int width);
+    Entity      at(int row, int col) const;
+    Entity      insert(int row, int col, Entity entity);
+    Entity      remove(int row, int col);
+    std::size_t size() const;
+    void        foreach(int top, int left, int height, int width,
+                    std::function<void(int, int, Entity)> callback) const;
+
+private:
+    struct Bucket {
+        std::array<std::uint64_t, 4> occupied_{};
+        std::vector<Entity>          items_{};
+    };
+
+    Bucket&     bucket(int row, int col);
+    const Bucket& bucket(int row, int col) const;
+
+    int                 height_;
+    int                 width_;
+    int                 bucketCols_;
+    std::size_t         size_;
+    std::vector<Bucket> buckets_;
+};
+
+#endif // ITEMGRID_H
@@ -1,13 +0,0 @@
-#ifndef KEY_H
-#define KEY_H
-
-#include "item.h"
-
-class Key : public Item
-{
-public:
-    Key();
-    virtual ~Key();
-};
-
-#endif // KEY_H
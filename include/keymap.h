@@ -0,0 +1,29 @@
+#ifndef KEYMAP_H
+#define KEYMAP_H
+
+#include <functional>
+#include <memory>
+
+#include "direction.h"
+#include "state.h"
+
+class Game;
+
+// Bindings from keystrokes to game commands and directions.  The default
+// bindings only use plain characters so they can be shared by every View;
+// a View may bind additional keys (e.g. cursor keys) on top of them.
+class Keymap {
+public:
+    Keymap();
+    ~Keymap();
+    void      bindCommand(int key, std::function<STATE(Game*)> command);
+    void      bindDirection(int key, DIRECTION direction);
+    STATE     command(int key, Game* game) const;
+    DIRECTION direction(int key) const;
+
+private:
+    struct KeymapImpl;
+    std::unique_ptr<KeymapImpl> impl_;
+};
+
+#endif // KEYMAP_H
@@ -0,0 +1,27 @@
+#ifndef LEVELBATCH_H
+#define LEVELBATCH_H
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+#include "maze.h"
+#include "phase.h"
+
+// Generates a run of levels with consecutive seeds on several threads and
+// writes them out in seed order, so the output doesn't depend on how many
+// threads were used.
+class LevelBatch {
+public:
+    LevelBatch(int height, int width, MAZE maze, std::uint64_t firstSeed);
+    ~LevelBatch();
+    void   run(unsigned long count, unsigned long threads, std::ostream& out);
+    double seconds() const;
+    double phaseSeconds(PHASE phase) const;
+
+private:
+    struct LevelBatchImpl;
+    std::unique_ptr<LevelBatchImpl> impl_;
+};
+
+#endif // LEVELBATCH_H
@@ -0,0 +1,13 @@
+#ifndef MAZE_H
+#define MAZE_H
+
+#include <cstdint>
+
+// The algorithms World::create() can build its maze with.  SIMPLE is the
+// original random walk with random restarts; the others run in time
+// proportional to the number of cells.  ELLER only needs one row of cells
+// at a time so it can also build endless mazes.
+enum class MAZE : std::uint8_t { SIMPLE = 0, BACKTRACKER, GROWING_TREE,
+    KRUSKAL, PRIM, WILSON, ELLER, COUNT };
+
+#endif // MAZE_H
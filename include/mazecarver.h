@@ -0,0 +1,37 @@
+#ifndef MAZECARVER_H
+#define MAZECARVER_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include "maze.h"
+
+class Random;
+
+// Carves perfect mazes.  The map is divided into cells at odd rows and
+// columns with walls between them; carve() calls open(row, col) for each
+// cell and each wall between connected cells in the order they are opened.
+// The working storage is kept between calls so a carver can be reused for
+// many mazes without allocating.
+class MazeCarver {
+public:
+    MazeCarver();
+    ~MazeCarver();
+    void carve(MAZE algorithm, int height, int width, Random& rng,
+        const std::function<void(int, int)>& open);
+
+    // Eller's algorithm for mazes with no bottom.  After startRows(), each
+    // carveRow() opens the next row of cells and the passages down from
+    // it, keeping nothing but the state of that row.
+    void startRows(int width);
+    void carveRow(Random& rng, const std::function<void(int, int)>& open);
+
+    static const char* name(MAZE algorithm);
+    static bool        parse(const std::string& name, MAZE& algorithm);
+
+private:
+    struct MazeCarverImpl;
+    std::unique_ptr<MazeCarverImpl> impl_;
+};
+
+#endif // MAZECARVER_H
@@ -0,0 +1,53 @@
+#ifndef MESSAGELOG_H
+#define MESSAGELOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Longer messages are cut short.
+constexpr std::size_t MESSAGE_LENGTH = 240;
+constexpr std::size_t DEFAULT_HISTORY = 1000;
+// Room for this many wrapped lines per message, on average, is kept.
+constexpr std::size_t LINES_PER_MESSAGE = 4;
+
+// The last history messages, word wrapped to a given width.  All the space
+// is allocated up front: messages are copied into fixed slots in a ring and
+// the wrapped lines are views of them kept in a second ring.  A message is
+// wrapped once when it is added and the whole log only when the width
+// changes.  When the line ring is full the oldest lines go first, so with
+// a very narrow width less history is kept.
+class MessageLog {
+public:
+    explicit MessageLog(std::size_t history = DEFAULT_HISTORY,
+        std::size_t width = 80);
+    ~MessageLog()=default;
+    void             add(std::string_view message);
+    void             clear();
+    std::size_t      lines() const;
+    std::string_view line(std::size_t back) const;
+    std::size_t      messages() const;
+    void             setWidth(std::size_t width);
+    std::size_t      width() const;
+
+private:
+    struct Line {
+        std::uint32_t message;
+        std::uint16_t begin;
+        std::uint16_t length;
+    };
+
+    void             wrap(std::size_t message);
+
+    std::vector<char>          text_;
+    std::vector<std::uint16_t> lengths_;
+    std::vector<Line>          lines_;
+    std::size_t                width_;
+    std::size_t                nextMessage_;
+    std::size_t                messageCount_;
+    std::size_t                nextLine_;
+    std::size_t                lineCount_;
+};
+
+#endif // MESSAGELOG_H
@@ -0,0 +1,50 @@
+#ifndef MONSTERS_H
+#define MONSTERS_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include "entities.h"
+
+class Pathing;
+class Player;
+class Random;
+class World;
+
+// Monsters within WAKE_RADIUS tiles of the player wake up and come after
+// them.  Awake ones which end up further away than SLEEP_RADIUS go back to
+// sleep.
+constexpr int WAKE_RADIUS  = 8;
+constexpr int SLEEP_RADIUS = 16;
+
+// What Monsters has done so far.  Awake is how many are awake now.
+struct MonsterStats {
+    unsigned long turns;
+    unsigned long actions;
+    unsigned long woken;
+    unsigned long slept;
+    std::size_t   awake;
+};
+
+// Gives the monsters near the player their turns.  Monsters act on energy:
+// each gains its speed in energy every turn and spends 100 on an action.
+// Rather than topping up every monster each turn, a priority queue keeps
+// when each awake one will next have enough, so a turn only touches the
+// monsters due to act.  Sleeping monsters aren't in the queue at all and
+// cost nothing, so a turn costs the same however big the level is.
+class Monsters {
+public:
+    Monsters();
+    ~Monsters();
+    int          turn(World& world, Player& player, Pathing& pathing,
+                     Random& rng, Entity engaged,
+                     std::function<void(std::string_view)> message);
+    MonsterStats stats() const;
+
+private:
+    struct MonstersImpl;
+    std::unique_ptr<MonstersImpl> impl_;
+};
+
+#endif // MONSTERS_H
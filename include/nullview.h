@@ -0,0 +1,33 @@
+#ifndef NULLVIEW_H
+#define NULLVIEW_H
+
+#include <memory>
+#include <string>
+
+#include "view.h"
+
+// A View that draws nothing and reads its keystrokes from a script.  When the
+// script runs out, the game is told to quit.
+class NullView : public View {
+public:
+    explicit NullView(std::string script);
+    virtual ~NullView();
+    void  alert() override;
+    STATE draw(World& world, Player& player) override;
+    void  end() override;
+    STATE handleTopLevelInput(Game* game) override;
+    DIRECTION handleDirectionInput(Game* game) override;
+    int   handleNumericalInput(Game* game) override;
+    bool  handleBooleanInput(Game* game) override;
+    void  init(std::string titleText) override;
+    void  message(std::string_view msg) override;
+    void  pause(Game* game) override;
+    void  refresh() override;
+    void  resize(World& world) override;
+    void  shell() override;
+private:
+    struct NullViewImpl;
+    std::unique_ptr<NullViewImpl> impl_;
+};
+
+#endif // NULLVIEW_H
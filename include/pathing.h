@@ -0,0 +1,71 @@
+#ifndef PATHING_H
+#define PATHING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "entities.h"
+
+class World;
+
+// What a distance field measures the way to.
+enum class GOAL : std::uint8_t {
+    PLAYER,     // wherever the player is
+    EXIT,       // the way out at the bottom of the level
+    FRONTIER,   // the nearest seen tile next to one which hasn't been seen
+    COUNT
+};
+
+constexpr std::uint32_t UNREACHABLE = UINT32_MAX;
+
+// Levels of up to FIELD_TILES tiles get fields covering the whole of them.
+// Bigger ones, and endless and chunked mazes, get fields covering the
+// square FIELD_RADIUS tiles around the player instead, which is moved
+// along once the player is halfway to its edge.  The player field only
+// ever covers PLAYER_FIELD_RADIUS tiles around the player; that is as far
+// as anything chasing them needs.
+constexpr std::size_t FIELD_TILES         = 1 << 20;
+constexpr int         FIELD_RADIUS        = 128;
+constexpr int         PLAYER_FIELD_RADIUS = 32;
+
+// What Pathing has done so far.  Visited is the number of tiles given a
+// distance, by rebuilds and updates together.
+struct PathingStats {
+    unsigned long rebuilds;
+    unsigned long updates;
+    unsigned long visited;
+};
+
+// Distance fields over the map: for each tile, how many steps it is to the
+// nearest tile of a GOAL, and so which way to go to get there.  There is
+// one field per goal which everything going there shares, so the cost is a
+// search of the map per change rather than one per monster.  Closed doors
+// are in the way and a known (sprung) trap costs as much as a detour of
+// several steps.  The frontier field only goes over tiles the player has
+// seen.
+//
+// Changes are noted as they happen and each field is brought up to date
+// when it is next asked for.  Rather than starting again, an update only
+// revisits the tiles whose distances the change could have affected.
+class Pathing {
+public:
+    explicit Pathing(World& world);
+    ~Pathing();
+    void          reset();
+    void          changed(int row, int col);
+    void          looked(int row, int col, int radius);
+    std::uint32_t distance(GOAL goal, int row, int col);
+    bool          next(GOAL goal, int row, int col, int& toRow, int& toCol);
+    bool          route(GOAL goal, std::vector<Position>& path);
+    bool          travel(std::function<bool(int, int)> goal,
+                      std::vector<Position>& path);
+    PathingStats  stats() const;
+
+private:
+    struct PathingImpl;
+    std::unique_ptr<PathingImpl> impl_;
+};
+
+#endif // PATHING_H
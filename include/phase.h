@@ -0,0 +1,10 @@
+#ifndef PHASE_H
+#define PHASE_H
+
+#include <cstdint>
+
+// The phases of World::create(), in the order they run.
+enum class PHASE : std::uint8_t { GENERATE_MAZE = 0, ADD_EXITS, ADD_WALLS,
+    ADD_DOORS, SPECIALIZE_WALLS, COUNT };
+
+#endif // PHASE_H
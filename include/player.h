@@ -2,13 +2,15 @@
 #define PLAYER_H
 
 #include <functional>
+#include <memory>
 #include "combat.h"
+#include "entities.h"
 #include "item.h"
 
 class Player : public Combat {
 public:
-    Player();
-    ~Player()=default;
+    explicit Player(Entities& entities);
+    ~Player();
     int                      facingX() const;
     void                     setFacingX(int x);
     int                      facingY() const;
@@ -19,14 +21,15 @@ public:
     void                     setKeepMoving(bool move);
     bool                     pickup() const;
     void                     setPickup(bool pickup);
-    bool                     carry(Item* item);
-    bool                     wield(Item* item);
-    Item*                    drop(int dropped);
-    void                     foreach_carried(std::function<void(std::unique_ptr<Item>&)> callback);
-    void                     foreach_wielded(std::function<void(std::unique_ptr<Item>&)> callback);
+    bool                     carry(Item item);
+    bool                     wield(Item item);
+    Item                     drop(int dropped);
+    bool                     destroy(Item item);
+    void                     foreach_carried(std::function<void(Item)> callback);
+    void                     foreach_wielded(std::function<void(Item)> callback);
 private:
     struct PlayerImpl;
-    static PlayerImpl impl_;
+    std::unique_ptr<PlayerImpl> impl_;
 };
 
 #endif // PLAYER_H
@@ -1,13 +0,0 @@
-#ifndef POTION_H
-#define POTION_H
-
-#include "item.h"
-
-class Potion : public Item
-{
-public:
-    Potion();
-    virtual ~Potion();
-};
-
-#endif // POTION_H
@@ -0,0 +1,35 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// A small, fast pseudo-random number generator (xoshiro256**.)  Every World
+// and Game owns its own so they don't share state between threads, and the
+// same seed always produces the same sequence on every platform.
+class Random {
+public:
+    explicit Random(std::uint64_t seed = 0);
+    ~Random()=default;
+    std::uint64_t next();
+    std::uint32_t uniform(std::uint32_t n);
+    void          seed(std::uint64_t seed);
+    Random        split();
+
+    // Fisher-Yates shuffle.  std::shuffle isn't used because its results
+    // differ between standard libraries.
+    template<typename T>
+    void shuffle(std::vector<T>& v) {
+        for (std::size_t i = v.size(); i > 1; i--) {
+            std::swap(v[i - 1], v[uniform(static_cast<std::uint32_t>(i))]);
+        }
+    }
+
+private:
+    std::array<std::uint64_t, 4> state_;
+};
+
+#endif // RANDOM_H
@@ -0,0 +1,61 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <cstdint>
+#include <functional>
+
+constexpr unsigned DEFAULT_TICK_RATE = 50;
+constexpr unsigned DEFAULT_FRAME_RATE = 50;
+constexpr unsigned MAX_RATE = 1000;
+constexpr unsigned DEFAULT_MAX_CATCH_UP = 5;
+
+// How many times something ran and how long it took, in nanoseconds.
+struct Timing {
+    unsigned long count;
+    std::uint64_t total;
+    std::uint64_t worst;
+};
+
+// What a Scheduler has run so far.  Dropped ticks are the ones given up
+// because too many were overdue at once; skipped frames are the ones which
+// were overdue when the previous frame finished.
+struct SchedulerStats {
+    Timing        ticks;
+    Timing        frames;
+    unsigned long dropped;
+    unsigned long skipped;
+};
+
+// Runs simulation ticks and render frames at their own rates by the
+// monotonic clock.  Ticks keep a fixed timestep: when they fall behind the
+// missed ones are run back to back, but no more than the catch-up limit at
+// a time.  Frames never catch up; a late frame is just drawn once.
+class Scheduler {
+public:
+    explicit Scheduler(unsigned tickRate = DEFAULT_TICK_RATE,
+        unsigned frameRate = DEFAULT_FRAME_RATE,
+        unsigned maxCatchUp = DEFAULT_MAX_CATCH_UP);
+    ~Scheduler()=default;
+    void           setTickRate(unsigned perSecond);
+    void           setFrameRate(unsigned perSecond);
+    void           setMaxCatchUp(unsigned ticks);
+    void           start(std::uint64_t now);
+    void           requestFrame();
+    std::uint64_t  advance(std::uint64_t now, const std::function<void()>& tick,
+                       const std::function<void()>& frame);
+    SchedulerStats stats() const;
+
+    // CLOCK_MONOTONIC in nanoseconds.
+    static std::uint64_t now();
+
+private:
+    std::uint64_t  tickPeriod_;
+    std::uint64_t  framePeriod_;
+    unsigned       maxCatchUp_;
+    std::uint64_t  nextTick_;
+    std::uint64_t  nextFrame_;
+    bool           started_;
+    SchedulerStats stats_;
+};
+
+#endif // SCHEDULER_H
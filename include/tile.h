@@ -1,13 +1,19 @@
 #ifndef TILE_H
 #define TILE_H
 
-#include <memory>
+#include <cstddef>
 #include "terrain.h"
 
+class TileStore;
+
+// A lightweight handle to one tile of a TileStore.  It is cheap to copy and
+// only valid as long as the store it came from.
 class Tile {
 public:
-    Tile();
-    ~Tile();
+    Tile(TileStore& store, std::size_t index);
+    Tile(const Tile&)=default;
+    Tile& operator=(const Tile&)=default;
+    ~Tile()=default;
     bool    passable() const;
     void    setPassable(bool passable);
     bool    seen() const;
@@ -16,10 +22,14 @@ public:
     void    setTerrain(TERRAIN terrain);
     bool    visible() const;
     void    setVisible(bool visible);
-    bool    isBlock();
+    bool    door() const;
+    void    setDoor(bool door);
+    bool    isBlock() const;
+
+    static bool isBlock(TERRAIN terrain);
 
 private:
-    struct TileImpl;
-    std::unique_ptr<TileImpl> impl_;
+    TileStore*  store_;
+    std::size_t index_;
 };
 #endif // TILE_H
@@ -0,0 +1,50 @@
+#ifndef TILESTORE_H
+#define TILESTORE_H
+
+#include <cstddef>
+#include <vector>
+
+#include "bitlayer.h"
+#include "terrain.h"
+
+// Contiguous storage for the tiles of a map: one byte of terrain per tile
+// plus a packed bit per tile for each flag.  Tiles are addressed by their
+// row-major index.  Which tiles are floor and which are walls is kept as
+// layers too, along with which have doors, so passes over the map can work
+// on 64 tiles at a time.
+class TileStore {
+public:
+    TileStore();
+    ~TileStore()=default;
+    void        assign(std::size_t size);
+    std::size_t size() const;
+    bool        passable(std::size_t i) const;
+    void        setPassable(std::size_t i, bool passable);
+    bool        seen(std::size_t i) const;
+    void        setSeen(std::size_t i, bool seen);
+    TERRAIN     terrain(std::size_t i) const;
+    void        setTerrain(std::size_t i, TERRAIN terrain);
+    bool        visible(std::size_t i) const;
+    void        setVisible(std::size_t i, bool visible);
+    void        setAllVisible(bool visible);
+    void        setVisible(std::size_t first, std::size_t count, bool visible);
+    void        setSeen(std::size_t first, std::size_t count, bool seen);
+    bool        door(std::size_t i) const;
+    void        setDoor(std::size_t i, bool door);
+    void        clear(std::size_t first, std::size_t count);
+
+    const BitLayer& floors() const;
+    const BitLayer& walls() const;
+    const BitLayer& doors() const;
+
+private:
+    std::vector<TERRAIN> terrain_;
+    BitLayer             passable_;
+    BitLayer             seen_;
+    BitLayer             visible_;
+    BitLayer             floors_;
+    BitLayer             walls_;
+    BitLayer             doors_;
+};
+
+#endif // TILESTORE_H
@@ -0,0 +1,13 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+// Unsigned LEB128: seven bits per byte, low bits first, with the top bit set
+// on every byte but the last.
+void writeVarint(std::ostream& out, std::uint64_t value);
+bool readVarint(std::istream& in, std::uint64_t& value);
+
+#endif // VARINT_H
@@ -0,0 +1,7 @@
+#ifndef VERSION_H
+#define VERSION_H
+
+constexpr const char* NAME = "The Girl Who Played With The Dragons Nest";
+constexpr const char* VERSION = "1.2";
+
+#endif // VERSION_H
@@ -2,6 +2,7 @@
 #define VIEW_H
 
 #include <string>
+#include <string_view>
 
 #include "direction.h"
 #include "game.h"
@@ -9,26 +10,25 @@
 #include "world.h"
 #include "state.h"
 
+// Presentation and input interface used by Game.  CursesView draws to a
+// terminal; NullView replays a key script and draws nothing.
 class View {
 public:
     View()=default;
-    ~View()=default;
-    void  alert();
-    STATE draw(World& world, Player& player);
-    void  end();
-    STATE handleTopLevelInput(Game* game);
-    DIRECTION handleDirectionInput(Game* game);
-    int   handleNumericalInput(Game* game);
-    bool  handleBooleanInput(Game* game);
-    void  init(std::string titleText);
-    void  message(std::string msg);
-    void  pause(Game* game);
-    void  refresh();
-    void  resize(World& world);
-    void  shell();
-private:
-    struct ViewImpl;
-    static ViewImpl impl_;
+    virtual ~View()=default;
+    virtual void  alert()=0;
+    virtual STATE draw(World& world, Player& player)=0;
+    virtual void  end()=0;
+    virtual STATE handleTopLevelInput(Game* game)=0;
+    virtual DIRECTION handleDirectionInput(Game* game)=0;
+    virtual int   handleNumericalInput(Game* game)=0;
+    virtual bool  handleBooleanInput(Game* game)=0;
+    virtual void  init(std::string titleText)=0;
+    virtual void  message(std::string_view msg)=0;
+    virtual void  pause(Game* game)=0;
+    virtual void  refresh()=0;
+    virtual void  resize(World& world)=0;
+    virtual void  shell()=0;
 };
 
 #endif // VIEW_H
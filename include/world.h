@@ -1,17 +1,43 @@
 #ifndef WORLD_H
 #define WORLD_H
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <ostream>
+#include "chunkstore.h"
+#include "entities.h"
 #include "item.h"
+#include "maze.h"
+#include "phase.h"
 #include "tile.h"
 
+// Map dimensions are rounded up to odd numbers and clamped to this range.
+constexpr int DEFAULT_MAP_HEIGHT = 15;
+constexpr int DEFAULT_MAP_WIDTH  = 15;
+constexpr int MIN_MAP_SIZE       = 5;
+constexpr int MAX_MAP_SIZE       = 10001;
+constexpr MAZE DEFAULT_MAZE      = MAZE::BACKTRACKER;
+
+// How far the player can see, in tiles.
+constexpr int DEFAULT_FOV_RADIUS = 8;
+constexpr int MAX_FOV_RADIUS     = 64;
+
 class World
 {
 public:
-    World()=default;
-    ~World()=default;
-    void     create();
+    World();
+    ~World();
+    void     create(int height, int width, std::uint64_t seed,
+                MAZE maze = DEFAULT_MAZE);
+    void     createEndless(int width, std::uint64_t seed);
+    void     createChunked(int height, int width, std::uint64_t seed,
+                MAZE maze, std::size_t budget);
+    ChunkStats chunkStats() const;
+    bool     endless() const;
+    bool     chunked() const;
+    int      firstRow() const;
     int      height() const;
     int      width() const;
     int      playerRow() const;
@@ -19,17 +45,28 @@ public:
     int      playerCol() const;
     void     setPlayerCol(int col);
     int      startCol() const;
+    int      endCol() const;
+    void     returnToStart();
+    Entities& entities();
     void     foreach_item(int top, int left, int height, int width,
-                std::function<void(int, int, std::unique_ptr<Item>&)> callback);
-    Item*    itemAt(int row, int col) const;
-    void     insertItem(int row, int col, Item* item);
+                std::function<void(int, int, Item)> callback);
+    Item     itemAt(int row, int col) const;
+    void     insertItem(int row, int col, Item item);
     bool     removeItem(int row, int col, bool destroy = false);
+    bool     moveItem(int row, int col, int toRow, int toCol);
+    void     modified(int row, int col);
     void     setAllVisible(bool visibility);
     void     fov();
-    Tile*    tileAt(int row, int col) const;
+    int      fovRadius() const;
+    void     setFovRadius(int radius);
+    void     invalidateFov();
+    void     autotile(int top, int left, int height = 1, int width = 1);
+    Tile     tileAt(int row, int col) const;
+    double   phaseSeconds(PHASE phase) const;
+    void     write(std::ostream& out) const;
 private:
     struct WorldImpl;
-    static WorldImpl impl_;
+    std::unique_ptr<WorldImpl> impl_;
 };
 
 #endif // WORLD_H
@@ -1,45 +1,25 @@
 #include "armament.h"
 
-struct Armament::ArmamentImpl {
-    ArmamentImpl();
-    ArmamentImpl(int defenseBonus, int offenseBonus);
-    ~ArmamentImpl()=default;
-
-    int         defenseBonus_;
-    int         offenseBonus_;
-};
-
-Armament::Armament() : impl_ { new Armament::ArmamentImpl() } {
+Armament::Armament() : Armament(0, 0) {
 }
 
 Armament::Armament(int defenseBonus, int offenseBonus) :
-    impl_ { new Armament::ArmamentImpl(defenseBonus, offenseBonus) } {
-}
-
-Armament::~Armament() {
-
+defenseBonus_{static_cast<std::int16_t>(defenseBonus)},
+offenseBonus_{static_cast<std::int16_t>(offenseBonus)} {
 }
 
-
 int Armament::defenseBonus() const {
-    return impl_->defenseBonus_;
+    return defenseBonus_;
 }
 
 void Armament::setDefenseBonus(int defenseBonus) {
-    impl_->defenseBonus_ += defenseBonus;
+    defenseBonus_ += defenseBonus;
 }
 
 int Armament::offenseBonus() const {
-    return impl_->offenseBonus_;
+    return offenseBonus_;
 }
 
 void Armament::setOffenseBonus(int offenseBonus) {
-    impl_->offenseBonus_ += offenseBonus;
-}
-
-Armament::ArmamentImpl::ArmamentImpl() : ArmamentImpl(0, 0) {
-}
-
-Armament::ArmamentImpl::ArmamentImpl(int defenseBonus, int offenseBonus) :
-defenseBonus_{defenseBonus}, offenseBonus_{offenseBonus} {
+    offenseBonus_ += offenseBonus;
 }
@@ -0,0 +1,1183 @@
+#include <sys/resource.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <new>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "entities.h"
+#include "fight.h"
+#include "game.h"
+#include "item.h"
+#include "keymap.h"
+#include "mazecarver.h"
+#include "messagelog.h"
+#include "monsters.h"
+#include "nullview.h"
+#include "pathing.h"
+#include "player.h"
+#include "random.h"
+#include "scheduler.h"
+#include "world.h"
+
+// Micro-benchmarks for the game library.  Run with the name of a benchmark
+// followed by its arguments.
+
+using Benchmark = std::function<int(std::vector<std::string>&)>;
+
+// Every heap allocation in the program is counted so benchmarks can check
+// for them.
+static std::atomic<unsigned long> allocations{0};
+
+void* operator new(std::size_t size) {
+    allocations++;
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+static double seconds(std::function<void()> func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+static long peakRSS() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss; // kilobytes on Linux
+}
+
+// Time World::create() for square maps of the given sizes.  Run the sizes in
+// ascending order so the peak RSS reported for each is due to that size.
+static int generate(std::vector<std::string>& args) {
+    if (args.empty()) {
+        args = { "15", "1000", "10000" };
+    }
+
+    std::cout << "size\tseconds\ttiles/second\tpeak RSS (KiB)\tbytes/tile"
+              << std::endl;
+
+    for (auto& arg : args) {
+        int size = std::atoi(arg.c_str());
+        World world;
+        double elapsed = seconds([&]() { world.create(size, size, 1); });
+        double tiles = static_cast<double>(world.height()) * world.width();
+        long rss = peakRSS();
+
+        std::cout << world.height() << 'x' << world.width() << '\t'
+                  << elapsed << '\t' << tiles / elapsed << '\t' << rss << '\t'
+                  << rss * 1024.0 / tiles << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// Time full-map scans through World::tileAt() of the kind drawViewport and
+// fov() do.
+static int scan(std::vector<std::string>& args) {
+    int size = args.empty() ? 1001 : std::atoi(args[0].c_str());
+    int passes = args.size() < 2 ? 10 : std::atoi(args[1].c_str());
+
+    World world;
+    world.create(size, size, 1);
+    double tiles = static_cast<double>(world.height()) * world.width() *
+        passes;
+
+    long count = 0;
+    double elapsed = seconds([&]() {
+        for (int pass = 0; pass < passes; pass++) {
+            for (int row = 0; row < world.height(); row++) {
+                for (int col = 0; col < world.width(); col++) {
+                    Tile t = world.tileAt(row, col);
+                    count += t.passable() + t.isBlock() + t.visible() +
+                        t.seen();
+                }
+            }
+        }
+    });
+    std::cout << "read: " << elapsed * 1e9 / tiles << " ns/tile" << std::endl;
+
+    elapsed = seconds([&]() {
+        for (int pass = 0; pass < passes; pass++) {
+            world.setAllVisible(pass % 2);
+        }
+    });
+    std::cout << "setAllVisible: " << elapsed * 1e9 / tiles << " ns/tile"
+              << std::endl;
+
+    return count > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Time World::itemAt() point lookups over the whole map and foreach_item()
+// over viewport sized rectangles, as drawItems uses it.
+static int items(std::vector<std::string>& args) {
+    int size = args.empty() ? 1001 : std::atoi(args[0].c_str());
+    int viewport = 15;
+
+    World world;
+    world.create(size, size, 1);
+    double tiles = static_cast<double>(world.height()) * world.width();
+
+    long count = 0;
+    double elapsed = seconds([&]() {
+        for (int row = 0; row < world.height(); row++) {
+            for (int col = 0; col < world.width(); col++) {
+                count += static_cast<bool>(world.itemAt(row, col));
+            }
+        }
+    });
+    std::cout << "items: " << count << '\n'
+              << "itemAt: " << elapsed * 1e9 / tiles << " ns/lookup"
+              << std::endl;
+
+    long visited = 0;
+    long queries = 0;
+    elapsed = seconds([&]() {
+        for (int top = 0; top < world.height(); top += viewport) {
+            for (int left = 0; left < world.width(); left += viewport) {
+                world.foreach_item(top, left, viewport, viewport,
+                    [&](int, int, Item) { visited++; });
+                queries++;
+            }
+        }
+    });
+    std::cout << "foreach_item: " << elapsed * 1e9 / queries
+              << " ns/viewport (" << static_cast<double>(visited) / queries
+              << " items each)" << std::endl;
+
+    return visited == count ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Time each maze algorithm on square maps of the given sizes, on its own and
+// as the first phase of World::create() (which also places the items.)  Each
+// maze is checked to be perfect: every cell is reachable and there are no
+// loops.
+static int maze(std::vector<std::string>& args) {
+    if (args.empty()) {
+        args = { "15", "101", "1001" };
+    }
+
+    std::cout << "size\talgorithm\tcarve (s)\tns/cell\tgenerate phase (s)"
+              << std::endl;
+
+    MazeCarver carver;
+    World world;
+    bool perfect = true;
+    for (auto& arg : args) {
+        int size = std::atoi(arg.c_str()) | 1;
+        std::vector<char> open(static_cast<std::size_t>(size) * size, 0);
+        double cells = static_cast<double>((size - 1) / 2) * ((size - 1) / 2);
+
+        for (int m = 0; m < static_cast<int>(MAZE::COUNT); m++) {
+            MAZE algorithm = static_cast<MAZE>(m);
+            Random rng(1);
+            long opened = 0;
+            std::fill(open.begin(), open.end(), 0);
+            double carve = seconds([&]() {
+                carver.carve(algorithm, size, size, rng, [&](int row, int col) {
+                    open[static_cast<std::size_t>(row) * size + col] = 1;
+                    opened++;
+                });
+            });
+
+            // A spanning tree of the cells has one passage fewer than cells.
+            std::queue<std::size_t> next;
+            long reached = 0;
+            next.push(static_cast<std::size_t>(size) + 1);
+            open[next.front()] = 2;
+            while (!next.empty()) {
+                std::size_t i = next.front();
+                next.pop();
+                reached++;
+                for (std::size_t j : { i - 1, i + 1, i - size, i + size }) {
+                    if (open[j] == 1) {
+                        open[j] = 2;
+                        next.push(j);
+                    }
+                }
+            }
+            if (opened != 2 * cells - 1 || reached != opened) {
+                std::cerr << MazeCarver::name(algorithm) << " made an imperfect "
+                          << size << 'x' << size << " maze" << std::endl;
+                perfect = false;
+            }
+
+            world.create(size, size, 1, algorithm);
+            std::cout << size << 'x' << size << '\t'
+                      << MazeCarver::name(algorithm) << '\t' << carve << '\t'
+                      << carve * 1e9 / cells << '\t'
+                      << world.phaseSeconds(PHASE::GENERATE_MAZE) << std::endl;
+        }
+    }
+
+    return perfect ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Walk down an endless maze of the given width and check that memory use
+// stops growing once the first rows have been forgotten.
+static int endless(std::vector<std::string>& args) {
+    int width = args.empty() ? 1001 : std::atoi(args[0].c_str());
+    int rows = args.size() < 2 ? 100000 : std::atoi(args[1].c_str());
+
+    World world;
+    world.createEndless(width, 1);
+
+    std::cout << "rows\tseconds\trows/second\tpeak RSS (KiB)" << std::endl;
+
+    long startRSS = 0;
+    long endRSS = 0;
+    int row = 0;
+    for (int step = rows / 10; row < rows; ) {
+        double elapsed = seconds([&]() {
+            for (int i = 0; i < step; i++) {
+                world.setPlayerRow(++row);
+            }
+        });
+        endRSS = peakRSS();
+        if (startRSS == 0) {
+            startRSS = endRSS;
+        }
+        std::cout << row << '\t' << elapsed << '\t' << step / elapsed << '\t'
+                  << endRSS << std::endl;
+    }
+
+    for (int p = 0; p < static_cast<int>(PHASE::COUNT); p++) {
+        std::cout << "phase " << p << ": "
+                  << world.phaseSeconds(static_cast<PHASE>(p)) * 1e9 / row
+                  << " ns/row" << std::endl;
+    }
+
+    return endRSS == startRSS ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Time fov() at radius 8, 16 and 32 from random places on a maze and on
+// the same map with every wall and door taken away, where the most tiles
+// are in view.  A call from the same place as the last is also timed; it
+// should cost next to nothing since nothing has changed.
+static int fov(std::vector<std::string>& args) {
+    int size = args.empty() ? 1001 : std::atoi(args[0].c_str());
+    const int calls = 10000;
+
+    World world;
+    world.create(size, size, 1);
+    size = world.height();
+
+    Random rng(2);
+    std::vector<std::pair<int, int>> places;
+    for (int i = 0; i < calls; i++) {
+        places.emplace_back(static_cast<int>(rng.uniform(size)),
+            static_cast<int>(rng.uniform(size)));
+    }
+
+    std::cout << "map\tradius\tus/call\tvisible/call\tunchanged ns/call"
+              << std::endl;
+
+    bool ok = true;
+    for (const char* map : { "maze", "open" }) {
+        if (std::string(map) == "open") {
+            for (int row = 0; row < size; row++) {
+                for (int col = 0; col < size; col++) {
+                    Tile t = world.tileAt(row, col);
+                    if (t.door()) {
+                        world.removeItem(row, col, true);
+                    }
+                    t.setTerrain(TERRAIN::FLOOR);
+                    t.setPassable(true);
+                }
+            }
+        }
+
+        for (int radius : { 8, 16, 32 }) {
+            world.setFovRadius(radius);
+            double elapsed = seconds([&]() {
+                for (auto& place : places) {
+                    world.setPlayerRow(place.first);
+                    world.setPlayerCol(place.second);
+                    world.fov();
+                }
+            });
+
+            long visible = 0;
+            for (int row = places.back().first - radius;
+            row <= places.back().first + radius; row++) {
+                for (int col = places.back().second - radius;
+                col <= places.back().second + radius; col++) {
+                    if (row >= 0 && row < size && col >= 0 && col < size) {
+                        visible += world.tileAt(row, col).visible();
+                    }
+                }
+            }
+
+            double unchanged = seconds([&]() {
+                for (int i = 0; i < calls; i++) {
+                    world.fov();
+                }
+            });
+
+            std::cout << map << '\t' << radius << '\t'
+                      << elapsed * 1e6 / calls << '\t' << visible << '\t'
+                      << unchanged * 1e9 / calls << std::endl;
+            ok = ok && visible > 0;
+        }
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Wander in straight lines around a chunked maze much bigger than its memory
+// budget, looking around and picking things up, then go back to the same
+// places and check that nothing that changed was forgotten when its chunk
+// was evicted.
+static int chunks(std::vector<std::string>& args) {
+    int size = args.empty() ? 10001 : std::atoi(args[0].c_str());
+    std::size_t budget = (args.size() < 2 ? 16 :
+        std::strtoul(args[1].c_str(), nullptr, 10)) << 20;
+    const int legs = 100;
+    const int steps = 200;
+
+    World world;
+    world.createChunked(size, size, 1, DEFAULT_MAZE, budget);
+    size = world.height();
+
+    Random rng(2);
+    std::vector<std::pair<int, int>> places;
+    std::vector<bool> taken;
+    int row = size / 2;
+    int col = size / 2;
+    for (int leg = 0; leg < legs; leg++) {
+        int dy = static_cast<int>(rng.uniform(3)) - 1;
+        int dx = static_cast<int>(rng.uniform(3)) - 1;
+        for (int step = 0; step < steps; step++) {
+            row = std::clamp(row + dy, 0, size - 1);
+            col = std::clamp(col + dx, 0, size - 1);
+            places.emplace_back(row, col);
+        }
+    }
+    double visits = static_cast<double>(places.size());
+
+    unsigned long items = 0;
+    double first = seconds([&]() {
+        for (auto& place : places) {
+            world.setPlayerRow(place.first);
+            world.setPlayerCol(place.second);
+            world.fov();
+            taken.push_back(world.removeItem(place.first, place.second, true));
+            world.foreach_item(place.first - 12, place.second - 40, 24, 80,
+            [&](int, int, Item) { items++; });
+        }
+    });
+    ChunkStats stats = world.chunkStats();
+    std::cout << "first visits: " << first * 1e6 / visits << " us/visit, "
+              << items << " items seen, " << stats.misses << " misses, "
+              << stats.evictions << " evictions, " << stats.spills
+              << " spills" << std::endl;
+
+    // The doors and traps next to each place are changed on the way round
+    // a second time, after their chunks have been read back in, and have to
+    // be found the same way once they have been evicted again.
+    bool kept = true;
+    std::map<std::pair<int, int>, bool> changed;
+    double second = seconds([&]() {
+        for (std::size_t i = 0; i < places.size(); i++) {
+            std::tie(row, col) = places[i];
+            Tile tile = world.tileAt(row, col);
+            if (tile.passable() && !tile.seen()) {
+                kept = false;
+            }
+            if (taken[i] && world.itemAt(row, col)) {
+                kept = false;
+            }
+            world.foreach_item(row - 1, col - 1, 3, 3,
+            [&](int r, int c, Item item) {
+                if (DoorState* door = item.door()) {
+                    door->open = !door->open;
+                    changed[{r, c}] = door->open;
+                } else if (TrapState* trap = item.trap()) {
+                    trap->sprung = true;
+                    changed[{r, c}] = true;
+                } else {
+                    return;
+                }
+                world.modified(r, c);
+            });
+        }
+    });
+    // Going over the same path on the far side of the maze evicts them.
+    for (auto& place : places) {
+        world.tileAt(size - 1 - place.first, size - 1 - place.second);
+    }
+    for (auto& change : changed) {
+        Item item = world.itemAt(change.first.first, change.first.second);
+        bool now = item.door() ? item.door()->open :
+            item.trap() && item.trap()->sprung;
+        if (now != change.second) {
+            kept = false;
+        }
+    }
+    stats = world.chunkStats();
+    std::cout << "second visits: " << second * 1e6 / visits << " us/visit, "
+              << changed.size() << " doors and traps changed, "
+              << stats.restores << " restores, " << stats.misses
+              << " misses in all\n"
+              << "resident: " << stats.resident << " chunks, " << stats.bytes
+              << " bytes (budget " << budget << ")\n"
+              << "peak RSS: " << peakRSS() << " KiB for "
+              << static_cast<double>(size) * size / 1e6 << "M tiles\n"
+              << (kept ? "changes kept" : "CHANGES LOST") << std::endl;
+
+    return kept ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Run a Scheduler on the real clock for a few seconds at 50 ticks a second
+// with frames at 50, 10 and 2 a second, sleeping in between, and check the
+// number of ticks doesn't depend on the frame rate.  Then stall it for a
+// second on a made up clock and check it catches up no more than it should.
+static int schedule(std::vector<std::string>& args) {
+    double duration = args.empty() ? 2.0 : std::atof(args[0].c_str());
+    const unsigned tickRate = 50;
+    const auto expected = static_cast<unsigned long>(duration * tickRate);
+
+    std::cout << "frames/s\tticks\tframes\tdropped\tskipped\t"
+              << "tick ns (mean/worst)\tframe ns (mean/worst)" << std::endl;
+
+    bool ok = true;
+    for (unsigned frameRate : { 50u, 10u, 2u }) {
+        Scheduler scheduler(tickRate, frameRate);
+        std::uint64_t start = Scheduler::now();
+        auto end = start + static_cast<std::uint64_t>(duration * 1e9);
+        unsigned long ticks = 0;
+        unsigned long frames = 0;
+        scheduler.start(start);
+        for (std::uint64_t now = start; now < end; now = Scheduler::now()) {
+            std::uint64_t wait = scheduler.advance(now,
+                [&]() { ticks++; }, [&]() { frames++; });
+            wait = std::min(wait, end - now);
+            timespec ts = { static_cast<time_t>(wait / 1000000000),
+                static_cast<long>(wait % 1000000000) };
+            clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, nullptr);
+        }
+
+        SchedulerStats stats = scheduler.stats();
+        auto mean = [](const Timing& t) {
+            return t.count == 0 ? 0 : t.total / t.count;
+        };
+        std::cout << frameRate << '\t' << stats.ticks.count << '\t'
+                  << stats.frames.count << '\t' << stats.dropped << '\t'
+                  << stats.skipped << '\t' << mean(stats.ticks) << '/'
+                  << stats.ticks.worst << "\t\t" << mean(stats.frames) << '/'
+                  << stats.frames.worst << std::endl;
+        ok = ok && ticks == stats.ticks.count && frames == stats.frames.count &&
+            ticks + 1 >= expected && ticks <= expected + 1;
+    }
+
+    Scheduler stalled(tickRate, tickRate, DEFAULT_MAX_CATCH_UP);
+    unsigned long ticks = 0;
+    const std::uint64_t second = 1000000000;
+    stalled.start(0);
+    stalled.advance(0, [&]() { ticks++; }, []() {});
+    stalled.advance(second, [&]() { ticks++; }, []() {});
+    SchedulerStats stats = stalled.stats();
+    std::cout << "after a 1 s stall: " << ticks << " ticks, " << stats.dropped
+              << " dropped, " << stats.frames.count << " frames" << std::endl;
+    ok = ok && ticks == 1 + DEFAULT_MAX_CATCH_UP &&
+        ticks + stats.dropped == tickRate + 1 && stats.frames.count == 2;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Go through the monsters of a size x size level the way a system would,
+// adding up their health: once over the whole map with foreach_item() and
+// Item::combat(), the way it used to have to be done, and once straight
+// down the packed combat components.  Both must come to the same total.
+// Also how much the entity store holds per entity.
+static int entities(std::vector<std::string>& args) {
+    int size = args.empty() ? 1001 : std::atoi(args[0].c_str());
+    const int passes = 20;
+
+    World world;
+    world.create(size, size, 1);
+    size = world.height();
+    const Entities& store = world.entities();
+    double monsters = static_cast<double>(store.combat().size()) * passes;
+
+    long sums[2] = { 0, 0 };
+    double mapped = seconds([&]() {
+        for (int pass = 0; pass < passes; pass++) {
+            world.foreach_item(0, 0, size, world.width(),
+            [&](int, int, Item item) {
+                if (Combat* combat = item.combat()) {
+                    sums[0] += combat->health();
+                }
+            });
+        }
+    });
+    double packed = seconds([&]() {
+        for (int pass = 0; pass < passes; pass++) {
+            for (const Combat& combat : store.combat().values()) {
+                sums[1] += combat.health();
+            }
+        }
+    });
+
+    std::cout << store.size() << " entities, " << store.combat().size()
+              << " monsters on a " << size << 'x' << size << " level\n"
+              << "foreach_item: " << mapped * 1e9 / monsters
+              << " ns/monster, packed: " << packed * 1e9 / monsters
+              << " ns/monster\n"
+              << static_cast<double>(store.bytes()) / store.size()
+              << " store bytes/entity" << std::endl;
+
+    return sums[0] == sums[1] && sums[0] > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Walk the player around size x size levels with the monsters hunting them,
+// jumping somewhere else every so often so that new ones wake up, and time
+// the monsters' turns.  Sleeping monsters cost nothing, so the time per turn
+// should stay the same however many monsters the level has.
+static int monsters(std::vector<std::string>& args) {
+    std::vector<int> sizes;
+    for (auto& arg : args) {
+        sizes.push_back(std::atoi(arg.c_str()));
+    }
+    if (sizes.empty()) {
+        sizes = { 101, 301, 1001 };
+    }
+    const int turns = 20000;
+    const int leg = 100;
+
+    std::cout << "size\tmonsters\tawake\tus/turn\tworst us" << std::endl;
+    bool ok = true;
+    for (int size : sizes) {
+        World world;
+        world.create(size, size, 1);
+        size = world.height();
+        Player player(world.entities());
+        Pathing pathing(world);
+        Monsters monsters;
+        Random rng(2);
+        std::size_t count = world.entities().combat().size();
+        auto empty = [&](int row, int col) {
+            return row >= 0 && row < size && col >= 0 && col < size &&
+                world.tileAt(row, col).passable() && !world.itemAt(row, col);
+        };
+
+        std::uint64_t total = 0;
+        std::uint64_t worst = 0;
+        double awake = 0;
+        for (int turn = 0; turn < turns; turn++) {
+            int row = world.playerRow();
+            int col = world.playerCol();
+            if (turn % leg == 0) {
+                do {
+                    row = static_cast<int>(rng.uniform(size));
+                    col = static_cast<int>(rng.uniform(size));
+                } while (!empty(row, col));
+            } else {
+                row += static_cast<int>(rng.uniform(3)) - 1;
+                col += static_cast<int>(rng.uniform(3)) - 1;
+                if (!empty(row, col)) {
+                    row = world.playerRow();
+                    col = world.playerCol();
+                }
+            }
+            world.setPlayerRow(row);
+            world.setPlayerCol(col);
+
+            std::uint64_t start = Scheduler::now();
+            monsters.turn(world, player, pathing, rng, NO_ENTITY,
+                [](std::string_view) {});
+            std::uint64_t elapsed = Scheduler::now() - start;
+            total += elapsed;
+            worst = std::max(worst, elapsed);
+            awake += static_cast<double>(monsters.stats().awake);
+            player.setHealth(10 - player.health());
+        }
+
+        double perTurn = static_cast<double>(total) / turns / 1e3;
+        std::cout << size << '\t' << count << '\t' << awake / turns << '\t'
+                  << perTurn << '\t' << worst / 1e3 << std::endl;
+        ok = ok && perTurn < 1000;
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Build the distance field to the exit of size x size levels with every
+// door open, then open and close doors at random, with every fourth change
+// springing a trap instead, and time bringing it up to date after each.
+// The updated field has to come out the same as one built from scratch.
+static int pathing(std::vector<std::string>& args) {
+    std::vector<int> sizes;
+    for (auto& arg : args) {
+        sizes.push_back(std::atoi(arg.c_str()));
+    }
+    if (sizes.empty()) {
+        sizes = { 101, 301, 1001 };
+    }
+    const int changes = 1000;
+
+    std::cout << "size\tto exit\tbuild us\tupdate us\ttiles/update"
+              << std::endl;
+    bool ok = true;
+    for (int size : sizes) {
+        World world;
+        world.create(size, size, 1);
+        size = world.height();
+        std::vector<DoorState*> doors;
+        std::vector<Position> places;
+        Entities& entities = world.entities();
+        for (Entity door : entities.doors().entities()) {
+            if (const Position* position = entities.positions().find(door)) {
+                doors.push_back(entities.doors().find(door));
+                places.push_back(*position);
+            }
+        }
+        for (DoorState* door : doors) {
+            door->open = true;
+        }
+        std::vector<TrapState*> traps;
+        std::vector<Position> trapPlaces;
+        for (Entity trap : entities.traps().entities()) {
+            if (const Position* position = entities.positions().find(trap)) {
+                traps.push_back(entities.traps().find(trap));
+                trapPlaces.push_back(*position);
+            }
+        }
+
+        Pathing pathing(world);
+        std::uint64_t start = Scheduler::now();
+        std::uint32_t toExit = pathing.distance(GOAL::EXIT, 0,
+            world.startCol());
+        double build = static_cast<double>(Scheduler::now() - start) / 1e3;
+
+        Random rng(3);
+        std::uint64_t total = 0;
+        unsigned long visited = pathing.stats().visited;
+        std::size_t sprung = 0;
+        for (int i = 0; i < changes && !doors.empty(); i++) {
+            if (i % 4 == 3 && sprung < traps.size()) {
+                traps[sprung]->sprung = true;
+                pathing.changed(trapPlaces[sprung].row,
+                    trapPlaces[sprung].col);
+                sprung++;
+            } else {
+                std::size_t which = rng.uniform(
+                    static_cast<std::uint32_t>(doors.size()));
+                doors[which]->open = !doors[which]->open;
+                pathing.changed(places[which].row, places[which].col);
+            }
+            start = Scheduler::now();
+            pathing.distance(GOAL::EXIT, 0, world.startCol());
+            total += Scheduler::now() - start;
+        }
+        visited = pathing.stats().visited - visited;
+
+        Pathing fresh(world);
+        for (int row = 0; row < size && ok; row++) {
+            for (int col = 0; col < size; col++) {
+                if (pathing.distance(GOAL::EXIT, row, col) !=
+                fresh.distance(GOAL::EXIT, row, col)) {
+                    std::cerr << "pathing: " << size << 'x' << size
+                              << " field differs at " << row << ',' << col
+                              << std::endl;
+                    ok = false;
+                    break;
+                }
+            }
+        }
+
+        std::cout << size << '\t';
+        if (toExit == UNREACHABLE) {
+            std::cout << '-';
+        } else {
+            std::cout << toExit;
+        }
+        std::cout << '\t' << build << '\t'
+                  << static_cast<double>(total) / changes / 1e3 << '\t'
+                  << static_cast<double>(visited) / changes << std::endl;
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Add fight messages to a MessageLog and read back a screenful after each,
+// as CursesView does, and count the heap allocations.  The same messages
+// are also wrapped the way CursesView used to, with string streams and a
+// deque of lines, for comparison.
+static int messages(std::vector<std::string>& args) {
+    long count = args.empty() ? 1000000 : std::atol(args[0].c_str());
+    const std::size_t width = 52;
+    const std::size_t height = 15;
+    const char* texts[] = {
+        "You hit the kobold. The kobold hits you.",
+        "You miss the hobgoblin. The hobgoblin misses you. You are not "
+            "having a good day and it isn't going to get any better.",
+        "You kill the dragon. You have won!",
+    };
+
+    MessageLog log(DEFAULT_HISTORY, width);
+    std::size_t shown = 0;
+    unsigned long logAllocations = 0;
+    double logged = seconds([&]() {
+        unsigned long before = allocations;
+        for (long i = 0; i < count; i++) {
+            log.add(texts[i % 3]);
+            for (std::size_t row = 0; row < std::min(log.lines(), height); row++) {
+                shown += log.line(row).size();
+            }
+        }
+        logAllocations = allocations - before;
+    });
+
+    std::deque<std::string> lines;
+    unsigned long streamAllocations = 0;
+    double streamed = seconds([&]() {
+        unsigned long before = allocations;
+        for (long i = 0; i < count; i++) {
+            std::istringstream words(texts[i % 3]);
+            std::ostringstream wrapped;
+            std::string word;
+            if (words >> word) {
+                wrapped << word;
+                std::size_t left = width - word.length();
+                while (words >> word) {
+                    if (left < word.length() + 1) {
+                        wrapped << '\n' << word;
+                        left = width - word.length();
+                    } else {
+                        wrapped << ' ' << word;
+                        left -= word.length() + 1;
+                    }
+                }
+            }
+            std::string line;
+            std::istringstream split(wrapped.str());
+            while (std::getline(split, line)) {
+                lines.push_back(line);
+            }
+            while (lines.size() > height) {
+                lines.pop_front();
+            }
+            for (auto& l : lines) {
+                shown += l.size();
+            }
+        }
+        streamAllocations = allocations - before;
+    });
+
+    std::cout << "MessageLog: " << logged * 1e9 / count << " ns/message, "
+              << static_cast<double>(logAllocations) / count
+              << " allocations/message\n"
+              << "streams:    " << streamed * 1e9 / count << " ns/message, "
+              << static_cast<double>(streamAllocations) / count
+              << " allocations/message" << std::endl;
+
+    return logAllocations == 0 && shown > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Fights side by side, one to a lane of a 128-bit vector, for checking the
+// odds by simulation.  The dice come from a xoshiro128** generator per lane.
+constexpr int LANES = 4;
+typedef std::uint32_t Bits  __attribute__((vector_size(4 * LANES)));
+typedef std::int32_t  Lanes __attribute__((vector_size(4 * LANES)));
+
+struct Simulated {
+    long ended[static_cast<std::size_t>(ENDING::COUNT)];
+    long taken;
+    long takenSquared;
+    long rounds;
+};
+
+static Bits rotl(Bits x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+// A roll of ways out of ROLLS comes up when a 32-bit random number is below
+// this.
+static std::uint32_t threshold(int ways) {
+    std::uint64_t t = (static_cast<std::uint64_t>(ways) << 32) / ROLLS;
+    return static_cast<std::uint32_t>(std::min<std::uint64_t>(t, UINT32_MAX));
+}
+
+// Plays count fights of bout round by round, LANES at a time, and adds up
+// how they ended.  Each batch goes on until all of its fights are over.
+static Simulated simulate(const Bout& bout, long count, Random& rng) {
+    Simulated result{};
+    Bits state[4];
+    for (auto& s : state) {
+        for (int lane = 0; lane < LANES; lane++) {
+            s[lane] = static_cast<std::uint32_t>(rng.next() >> 32);
+        }
+    }
+    auto next = [&state]() {
+        Bits result = rotl(state[1] * 5, 7) * 9;
+        Bits t = state[1] << 9;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 11);
+        return result;
+    };
+
+    std::uint32_t monsterHits = threshold(hits(bout.monsterOffense,
+        bout.playerDefense));
+    std::uint32_t playerHits = threshold(hits(bout.playerOffense,
+        bout.monsterDefense));
+    int lives = (std::max(bout.playerHealth, 1) + bout.damage - 1) /
+        bout.damage;
+    int health = std::max(bout.monsterHealth, 1);
+    Lanes teleports = Lanes{} - (bout.teleports ? 1 : 0);
+
+    Lanes won{}, lost{}, both{}, teleported{}, taken{}, takenSquared{},
+        rounds{};
+    for (long batch = 0; batch < count / LANES; batch++) {
+        Lanes hit{}, dealt{}, struck{};
+        Lanes active = Lanes{} - 1;
+        Lanes took{};
+        bool going = true;
+        while (going) {
+            hit = (next() < monsterHits) & active;
+            struck = (next() < playerHits) & active;
+            took -= hit;
+            dealt -= struck;
+            rounds -= active;
+            Lanes dead = took >= lives;
+            Lanes killed = dealt >= health;
+            Lanes over = (dead | killed | (hit & teleports)) & active;
+            won -= over & killed & ~dead;
+            lost -= over & dead & ~killed;
+            both -= over & dead & killed;
+            teleported -= over & ~dead & ~killed;
+            taken += over & took;
+            takenSquared += over & (took * took);
+            active &= ~over;
+            going = false;
+            for (int lane = 0; lane < LANES; lane++) {
+                going = going || active[lane];
+            }
+        }
+    }
+
+    for (int lane = 0; lane < LANES; lane++) {
+        result.ended[static_cast<std::size_t>(ENDING::WON)] += won[lane];
+        result.ended[static_cast<std::size_t>(ENDING::LOST)] += lost[lane];
+        result.ended[static_cast<std::size_t>(ENDING::BOTH)] += both[lane];
+        result.ended[static_cast<std::size_t>(ENDING::TELEPORTED)] +=
+            teleported[lane];
+        result.taken += taken[lane];
+        result.takenSquared += takenSquared[lane];
+        result.rounds += rounds[lane];
+    }
+    return result;
+}
+
+// How many standard errors what count fights came to is from the odds,
+// taking the worst of the endings and the damage.  An ending so unlikely
+// that it should hardly ever come up is allowed an error of a few fights
+// rather than none at all.
+static double deviation(const Odds& odds, const Simulated& simulated,
+int damage, long count) {
+    double n = static_cast<double>(count);
+    double worst = 0;
+    for (std::size_t i = 0; i < odds.endings.size(); i++) {
+        double p = odds.endings[i];
+        double seen = simulated.ended[i] / n;
+        if (p > 0 && p < 1) {
+            worst = std::max(worst, std::abs(seen - p) /
+                std::max(std::sqrt(p * (1 - p) / n), 2 / n));
+        } else if (seen != p) {
+            return INFINITY;
+        }
+    }
+    double mean = simulated.taken / n;
+    double variance = simulated.takenSquared / n - mean * mean;
+    if (variance > 0) {
+        worst = std::max(worst, std::abs(mean * damage - odds.damage) /
+            (damage * std::sqrt(variance / n)));
+    }
+    return worst;
+}
+
+static std::string wielding(const Matchup& matchup) {
+    std::string names;
+    for (ARCHETYPE wielded : matchup.wielded) {
+        if (wielded != ARCHETYPE::NOTHING) {
+            names += (names.empty() ? "" : " and ");
+            names += archetype(wielded).name;
+        }
+    }
+    return names.empty() ? "bare hands" : names;
+}
+
+// Works out the exact odds of a fight to the death for every monster
+// against every pair of things the player could be wielding, then checks
+// them against count fights each picked by fight() and count more played
+// out round by round LANES at a time.  Shows the odds bare handed and with
+// whatever wins most often.
+static int fights(std::vector<std::string>& args) {
+    long count = args.empty() ? 200000 : std::atol(args[0].c_str());
+    count -= count % LANES;
+    Entities entities;
+    Player player(entities);
+
+    std::vector<Matchup> table;
+    const int repeats = 100;
+    double exact = seconds([&]() {
+        for (int i = 0; i < repeats; i++) {
+            table = matchups(player);
+        }
+    });
+
+    std::cout << "monster\t\twielding\twon\tlost\tdamage\trounds" << std::endl;
+    auto show = [](const Matchup& matchup) {
+        std::string name(archetype(matchup.monster).name);
+        std::cout << name << (name.size() < 8 ? "\t\t" : "\t")
+                  << wielding(matchup) << '\t'
+                  << matchup.odds.endings[static_cast<std::size_t>(
+                         ENDING::WON)] << '\t'
+                  << matchup.odds.endings[static_cast<std::size_t>(
+                         ENDING::LOST)] << '\t'
+                  << matchup.odds.damage << '\t' << matchup.odds.rounds
+                  << std::endl;
+    };
+    for (std::size_t i = 0; i < table.size(); ) {
+        std::size_t best = i;
+        std::size_t j = i;
+        for (; j < table.size() && table[j].monster == table[i].monster;
+        j++) {
+            if (table[j].odds.endings[0] > table[best].odds.endings[0]) {
+                best = j;
+            }
+        }
+        show(table[i]);
+        if (best != i) {
+            show(table[best]);
+        }
+        i = j;
+    }
+
+    Random rng(5);
+    double sampledWorst = 0, simulatedWorst = 0;
+    double sampledTime = 0, simulatedTime = 0;
+    unsigned long rounds = 0;
+    for (auto& matchup : table) {
+        const Archetype& kind = archetype(matchup.monster);
+        Combat monster(kind.health, kind.offense, kind.defense);
+        int offense = 0, defense = 0;
+        for (ARCHETYPE wielded : matchup.wielded) {
+            offense += archetype(wielded).offense;
+            defense += archetype(wielded).defense;
+        }
+        Bout matched = bout(player, offense, defense, monster, kind.type);
+        if (matchup.odds.endings[static_cast<std::size_t>(
+        ENDING::STALEMATE)] > 0) {
+            continue;
+        }
+
+        Simulated sampled{};
+        sampledTime += seconds([&]() {
+            for (long i = 0; i < count; i++) {
+                Fight fought = fight(matched, rng);
+                sampled.ended[static_cast<std::size_t>(fought.ending)]++;
+                sampled.taken += fought.taken;
+                sampled.takenSquared += fought.taken * fought.taken;
+                sampled.rounds += static_cast<long>(fought.rounds);
+            }
+        });
+        sampledWorst = std::max(sampledWorst, deviation(matchup.odds, sampled,
+            matched.damage, count));
+
+        Simulated simulated{};
+        simulatedTime += seconds([&]() {
+            simulated = simulate(matched, count, rng);
+        });
+        simulatedWorst = std::max(simulatedWorst, deviation(matchup.odds,
+            simulated, matched.damage, count));
+        rounds += static_cast<unsigned long>(simulated.rounds);
+    }
+
+    double fought = static_cast<double>(count) * table.size();
+    std::cout << table.size() << " matchups: " << exact * 1e6 / repeats
+              << " us for the lot\n"
+              << "fight():  " << sampledTime * 1e9 / fought
+              << " ns/fight, worst " << sampledWorst << " standard errors\n"
+              << "simulated: " << simulatedTime * 1e9 / fought
+              << " ns/fight, " << rounds / fought << " rounds/fight, worst "
+              << simulatedWorst << " standard errors over " << fought
+              << " fights" << std::endl;
+
+    return sampledWorst < 5 && simulatedWorst < 5 ? EXIT_SUCCESS :
+        EXIT_FAILURE;
+}
+
+// Runs the length of a corridor over and over.  It is carved across the
+// middle of the level when the game sets it up, and each run starts from
+// the same place at one end of it.  Times from the key being handled to the
+// game asking for the next one, and counts the draws in between.
+class RunView : public NullView {
+public:
+    RunView(int length, int runs) : NullView(""), world_{nullptr}, keymap_{},
+    length_{length}, runs_{runs}, done_{0}, timing_{false}, start_{0},
+    total_{0}, worst_{0}, draws_{0}, steps_{0} {
+    }
+    RunView(const RunView&)=delete;
+    RunView& operator=(const RunView&)=delete;
+
+    STATE draw(World&, Player&) override {
+        draws_ += timing_;
+        return STATE::COMMAND;
+    }
+
+    // The game redraws before asking for a key, as CursesView does.
+    STATE handleTopLevelInput(Game* game) override {
+        game->draw();
+        timing_ = false;
+        if (done_ > 0) {
+            std::uint64_t elapsed = Scheduler::now() - start_;
+            total_ += elapsed;
+            worst_ = std::max(worst_, elapsed);
+            steps_ += static_cast<unsigned long>(world_->playerCol() - first());
+        }
+        if (done_ == runs_) {
+            return STATE::QUIT;
+        }
+        done_++;
+        world_->setPlayerRow(ROW);
+        world_->setPlayerCol(first());
+        game->draw();
+        timing_ = true;
+        start_ = Scheduler::now();
+        return keymap_.command('L', game);
+    }
+
+    void resize(World& world) override {
+        world_ = &world;
+        for (int col = 1; col < world.width() - 1; col++) {
+            for (int row = ROW - 1; row <= ROW + 1; row++) {
+                world.removeItem(row, col, true);
+                Tile tile = world.tileAt(row, col);
+                tile.setPassable(row == ROW);
+                tile.setTerrain(row == ROW ? TERRAIN::FLOOR :
+                    TERRAIN::H_WALL);
+            }
+        }
+        world.invalidateFov();
+    }
+
+    int           first() const { return world_->width() - 2 - length_; }
+    double        mean() const { return total_ / 1e3 / runs_; }
+    double        worst() const { return worst_ / 1e3; }
+    double        draws() const { return static_cast<double>(draws_) / runs_; }
+    double        steps() const { return static_cast<double>(steps_) / runs_; }
+
+private:
+    static constexpr int ROW = 7;
+
+    World*        world_;
+    Keymap        keymap_;
+    int           length_;
+    int           runs_;
+    int           done_;
+    bool          timing_;
+    std::uint64_t start_;
+    std::uint64_t total_;
+    std::uint64_t worst_;
+    long          draws_;
+    unsigned long steps_;
+};
+
+static int run(std::vector<std::string>& args) {
+    int length = args.empty() ? 200 : std::atoi(args[0].c_str());
+    const int runs = 2000;
+
+    RunView* view = new RunView(length, runs);
+    Game game{std::unique_ptr<View>(view)};
+    game.setSeed(1);
+    game.setWorldSize(15, length + 201);
+    game.run("bench", "");
+
+    std::cout << "steps/run\tdraws/run\tus/run\tworst us\n"
+              << view->steps() << '\t' << view->draws() << '\t'
+              << view->mean() << '\t' << view->worst() << std::endl;
+
+    return view->steps() == length && view->draws() == 1 ? EXIT_SUCCESS :
+        EXIT_FAILURE;
+}
+
+static const std::map<std::string, Benchmark> benchmarks = {
+    { "chunks",     chunks },
+    { "endless",    endless },
+    { "entities",   entities },
+    { "fights",     fights },
+    { "fov",        fov },
+    { "generate",   generate },
+    { "items",      items },
+    { "maze",       maze },
+    { "messages",   messages },
+    { "monsters",   monsters },
+    { "pathing",    pathing },
+    { "run",        run },
+    { "scan",       scan },
+    { "schedule",   schedule },
+};
+
+static void usage(const char* program) {
+    std::cerr << "usage: " << program << " benchmark [args...]\n"
+              << "benchmarks:\n"
+              << "  chunks [size [MB]]  wander a chunked maze kept in MB megabytes\n"
+              << "  endless [width [rows]]  walk down an endless maze\n"
+              << "  entities [size]     go through monsters by map and by packed components\n"
+              << "  fights [count]      work out the odds of every fight and check them by simulation\n"
+              << "  fov [size]          time fov() at radius 8, 16 and 32\n"
+              << "  generate [size...]  time World::create() for size x size maps\n"
+              << "  items [size]        time itemAt() and viewport foreach_item()\n"
+              << "  maze [size...]      time each maze algorithm for size x size maps\n"
+              << "  messages [count]    time adding messages to the log and count allocations\n"
+              << "  monsters [size...]  time the monsters' turns while they hunt the player\n"
+              << "  pathing [size...]   time building the exit distance field and updating it as doors change\n"
+              << "  run [length]        time running the length of a corridor\n"
+              << "  scan [size [passes]]  time full-map scans through World::tileAt()\n"
+              << "  schedule [seconds]  run ticks and frames on the clock at different rates\n";
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+    }
+
+    auto it = benchmarks.find(argv[1]);
+    if (it == benchmarks.end()) {
+        usage(argv[0]);
+    }
+
+    std::vector<std::string> args(argv + 2, argv + argc);
+    return (it->second)(args);
+}
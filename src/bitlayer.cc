@@ -0,0 +1,78 @@
+#include <algorithm>
+#include "bitlayer.h"
+
+static constexpr std::size_t WORDBITS = 64;
+
+BitLayer::BitLayer() : words_{}, size_{0} {
+}
+
+void BitLayer::assign(std::size_t size, bool value) {
+    size_ = size;
+    words_.assign((size + WORDBITS - 1) / WORDBITS, 0);
+    fill(value);
+}
+
+void BitLayer::fill(bool value) {
+    std::fill(words_.begin(), words_.end(), value ? ~std::uint64_t{0} : 0);
+
+    // Keep the unused bits of the last word clear.
+    if (value && size_ % WORDBITS != 0) {
+        words_.back() &= (std::uint64_t{1} << (size_ % WORDBITS)) - 1;
+    }
+}
+
+void BitLayer::fill(std::size_t first, std::size_t count, bool value) {
+    std::size_t last = first + count;
+    while (first < last) {
+        std::size_t bit = first % WORDBITS;
+        std::size_t n = std::min(WORDBITS - bit, last - first);
+        std::uint64_t mask = (n == WORDBITS ? ~std::uint64_t{0} :
+            ((std::uint64_t{1} << n) - 1)) << bit;
+        if (value) {
+            words_[first / WORDBITS] |= mask;
+        } else {
+            words_[first / WORDBITS] &= ~mask;
+        }
+        first += n;
+    }
+}
+
+std::size_t BitLayer::size() const {
+    return size_;
+}
+
+bool BitLayer::test(std::size_t i) const {
+    return (words_[i / WORDBITS] >> (i % WORDBITS)) & 1;
+}
+
+std::uint64_t BitLayer::word(std::size_t w) const {
+    return words_[w];
+}
+
+void BitLayer::copy(std::size_t first, std::size_t count,
+std::uint64_t* out) const {
+    std::size_t shift = first % WORDBITS;
+    const std::uint64_t* in = &words_[first / WORDBITS];
+    std::size_t words = (count + WORDBITS - 1) / WORDBITS;
+    std::size_t available = words_.size() - first / WORDBITS;
+
+    for (std::size_t w = 0; w < words; w++) {
+        std::uint64_t bits = in[w] >> shift;
+        if (shift != 0 && w + 1 < available) {
+            bits |= in[w + 1] << (WORDBITS - shift);
+        }
+        out[w] = bits;
+    }
+    if (count % WORDBITS != 0) {
+        out[words - 1] &= (std::uint64_t{1} << (count % WORDBITS)) - 1;
+    }
+}
+
+void BitLayer::set(std::size_t i, bool value) {
+    std::uint64_t mask = std::uint64_t{1} << (i % WORDBITS);
+    if (value) {
+        words_[i / WORDBITS] |= mask;
+    } else {
+        words_[i / WORDBITS] &= ~mask;
+    }
+}
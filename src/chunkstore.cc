@@ -0,0 +1,408 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include "chunkstore.h"
+#include "item.h"
+#include "itemgrid.h"
+#include "tilestore.h"
+#include "varint.h"
+
+// Rough memory use of a chunk: its tiles and item index, plus each item's
+// place in the grid and its share of the entity store.  Measured with
+// tgwpwtdn-bench chunks and entities.
+static constexpr std::size_t CHUNK_BYTES = 8 * 1024;
+static constexpr std::size_t ITEM_BYTES = 64;
+
+// Whatever the budget, keep enough chunks for the ones around the player.
+static constexpr std::size_t MIN_RESIDENT = 9;
+
+static constexpr std::size_t CHUNKTILES =
+    static_cast<std::size_t>(CHUNKSIZE) * CHUNKSIZE;
+
+struct Chunk {
+    Chunk() : key_{0}, tiles_{}, items_{}, changed_{false}, bytes_{0} {}
+
+    std::size_t key_;
+    TileStore   tiles_;
+    ItemGrid    items_;
+    bool        changed_;
+    std::size_t bytes_;
+};
+
+// Where a chunk was written in the spill file and how much room it has.
+struct Spilled {
+    long        offset_;
+    std::size_t size_;
+    std::size_t capacity_;
+};
+
+struct ChunkStore::ChunkStoreImpl {
+    ChunkStoreImpl();
+    ChunkStoreImpl(const ChunkStoreImpl&)=delete;
+    ChunkStoreImpl& operator=(const ChunkStoreImpl&)=delete;
+    ~ChunkStoreImpl();
+    Chunk& find(int row, int col);
+    void   load(Chunk& chunk);
+    bool   evict();
+    bool   spill(Chunk& chunk);
+    bool   restore(Chunk& chunk, const Spilled& spilled);
+    void   release(Chunk& chunk);
+
+    int                                                      height_;
+    int                                                      width_;
+    int                                                      chunkCols_;
+    std::size_t                                              budget_;
+    Entities*                                                entities_;
+    Generator                                                generate_;
+    std::list<Chunk>                                         chunks_;
+    std::unordered_map<std::size_t, std::list<Chunk>::iterator> index_;
+    std::unordered_map<std::size_t, Spilled>                 spilled_;
+    Chunk*                                                   last_;
+    std::FILE*                                               file_;
+    std::string                                              buffer_;
+    ChunkStats                                               stats_;
+};
+
+static std::size_t local(int row, int col) {
+    return static_cast<std::size_t>(row % CHUNKSIZE) * CHUNKSIZE +
+        col % CHUNKSIZE;
+}
+
+static void writeInt(std::ostream& out, int value) {
+    writeVarint(out, static_cast<std::uint64_t>(static_cast<std::int64_t>(value)));
+}
+
+static int readInt(std::istream& in) {
+    std::uint64_t value = 0;
+    readVarint(in, value);
+    return static_cast<int>(static_cast<std::int64_t>(value));
+}
+
+// An item is its archetype followed by whatever else about it can change.
+static void writeItem(std::ostream& out, const Entities& entities,
+Entity entity) {
+    out.put(static_cast<char>(entities.archetype(entity)));
+
+    if (const DoorState* door = entities.doors().find(entity)) {
+        out.put(static_cast<char>(door->horizontal | door->open << 1));
+    } else if (const TrapState* trap = entities.traps().find(entity)) {
+        out.put(static_cast<char>(trap->sprung));
+    } else if (const Combat* combat = entities.combat().find(entity)) {
+        writeInt(out, combat->health());
+        writeInt(out, combat->offense());
+        writeInt(out, combat->defense());
+    } else if (const Armament* armament = entities.armaments().find(entity)) {
+        writeInt(out, armament->offenseBonus());
+        writeInt(out, armament->defenseBonus());
+    }
+}
+
+static Entity readItem(std::istream& in, Entities& entities) {
+    int id = in.get();
+    if (id <= 0 || id >= static_cast<int>(ARCHETYPE::COUNT)) {
+        return NO_ENTITY;
+    }
+    Entity entity = entities.create(static_cast<ARCHETYPE>(id));
+
+    if (DoorState* door = entities.doors().find(entity)) {
+        int flags = in.get();
+        door->horizontal = flags & 1;
+        door->open = flags & 2;
+    } else if (TrapState* trap = entities.traps().find(entity)) {
+        trap->sprung = in.get() != 0;
+    } else if (Combat* combat = entities.combat().find(entity)) {
+        int health = readInt(in);
+        int offense = readInt(in);
+        int defense = readInt(in);
+        *combat = Combat(health, offense, defense);
+    } else if (Armament* armament = entities.armaments().find(entity)) {
+        int offenseBonus = readInt(in);
+        int defenseBonus = readInt(in);
+        *armament = Armament(defenseBonus, offenseBonus);
+    }
+    return entity;
+}
+
+ChunkStore::ChunkStore() : impl_{new ChunkStore::ChunkStoreImpl()} {
+}
+
+ChunkStore::~ChunkStore() {
+
+}
+
+void ChunkStore::assign(int height, int width, std::size_t budget,
+Entities& entities, Generator generate) {
+    clear();
+    impl_->entities_ = &entities;
+    impl_->height_ = height;
+    impl_->width_ = width;
+    impl_->chunkCols_ = (width + CHUNKSIZE - 1) / CHUNKSIZE;
+    impl_->budget_ = budget;
+    impl_->generate_ = generate;
+}
+
+void ChunkStore::clear() {
+    if (impl_->entities_ != nullptr) {
+        for (auto& chunk : impl_->chunks_) {
+            impl_->release(chunk);
+        }
+    }
+    impl_->chunks_.clear();
+    impl_->index_.clear();
+    impl_->spilled_.clear();
+    impl_->last_ = nullptr;
+    if (impl_->file_ != nullptr) {
+        std::fclose(impl_->file_);
+        impl_->file_ = nullptr;
+    }
+    impl_->stats_ = ChunkStats();
+}
+
+Tile ChunkStore::tileAt(int row, int col) {
+    return Tile(impl_->find(row, col).tiles_, local(row, col));
+}
+
+Entity ChunkStore::itemAt(int row, int col) {
+    return impl_->find(row, col).items_.at(row % CHUNKSIZE, col % CHUNKSIZE);
+}
+
+Entity ChunkStore::insert(int row, int col, Entity entity) {
+    Chunk& chunk = impl_->find(row, col);
+    Entity displaced = chunk.items_.insert(row % CHUNKSIZE, col % CHUNKSIZE,
+        entity);
+    if (displaced == NO_ENTITY) {
+        chunk.bytes_ += ITEM_BYTES;
+        impl_->stats_.bytes += ITEM_BYTES;
+    }
+    chunk.changed_ = true;
+    return displaced;
+}
+
+Entity ChunkStore::remove(int row, int col) {
+    Chunk& chunk = impl_->find(row, col);
+    Entity item = chunk.items_.remove(row % CHUNKSIZE, col % CHUNKSIZE);
+    if (item != NO_ENTITY) {
+        chunk.bytes_ -= ITEM_BYTES;
+        impl_->stats_.bytes -= ITEM_BYTES;
+    }
+    chunk.changed_ = true;
+    return item;
+}
+
+void ChunkStore::touch(int row, int col) {
+    impl_->find(row, col).changed_ = true;
+}
+
+// Visits the chunks under the rectangle one after another, so items come
+// out in row-major order within each chunk but not across them.
+void ChunkStore::foreach(int top, int left, int height, int width,
+std::function<void(int, int, Entity)> callback) {
+    int bottom = std::min(top + height, impl_->height_);
+    int right = std::min(left + width, impl_->width_);
+    top = std::max(top, 0);
+    left = std::max(left, 0);
+
+    for (int row = top; row < bottom; row = (row / CHUNKSIZE + 1) * CHUNKSIZE) {
+        int chunkTop = row - row % CHUNKSIZE;
+        int rows = std::min(bottom, chunkTop + CHUNKSIZE) - row;
+        for (int col = left; col < right;
+        col = (col / CHUNKSIZE + 1) * CHUNKSIZE) {
+            int chunkLeft = col - col % CHUNKSIZE;
+            int cols = std::min(right, chunkLeft + CHUNKSIZE) - col;
+            impl_->find(row, col).items_.foreach(row - chunkTop,
+                col - chunkLeft, rows, cols, [&](int r, int c, Entity item) {
+                    callback(chunkTop + r, chunkLeft + c, item);
+                });
+        }
+    }
+}
+
+// Only the chunks in memory; the rest would have to be generated first.
+void ChunkStore::setAllVisible(bool visible) {
+    for (auto& chunk : impl_->chunks_) {
+        chunk.tiles_.setAllVisible(visible);
+    }
+}
+
+ChunkStats ChunkStore::stats() const {
+    ChunkStats stats = impl_->stats_;
+    stats.resident = impl_->chunks_.size();
+    return stats;
+}
+
+// Private methods
+
+ChunkStore::ChunkStoreImpl::ChunkStoreImpl() : height_{0}, width_{0},
+chunkCols_{0}, budget_{0}, entities_{nullptr}, generate_{}, chunks_{}, index_{}, spilled_{},
+last_{nullptr}, file_{nullptr}, buffer_{}, stats_{} {
+}
+
+ChunkStore::ChunkStoreImpl::~ChunkStoreImpl() {
+    if (file_ != nullptr) {
+        std::fclose(file_);
+    }
+}
+
+// The chunk holding a tile, which becomes the most recently used.
+Chunk& ChunkStore::ChunkStoreImpl::find(int row, int col) {
+    std::size_t key = static_cast<std::size_t>(row / CHUNKSIZE) * chunkCols_ +
+        col / CHUNKSIZE;
+
+    if (last_ != nullptr && last_->key_ == key) {
+        stats_.hits++;
+        return *last_;
+    }
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        stats_.hits++;
+        chunks_.splice(chunks_.begin(), chunks_, it->second);
+        last_ = &chunks_.front();
+        return *last_;
+    }
+
+    stats_.misses++;
+    chunks_.emplace_front();
+    Chunk& chunk = chunks_.front();
+    chunk.key_ = key;
+    index_[key] = chunks_.begin();
+    last_ = &chunk;
+    load(chunk);
+
+    while (stats_.bytes > budget_ && chunks_.size() > MIN_RESIDENT) {
+        if (!evict()) {
+            break;
+        }
+    }
+
+    return chunk;
+}
+
+void ChunkStore::ChunkStoreImpl::load(Chunk& chunk) {
+    chunk.tiles_.assign(CHUNKTILES);
+    chunk.items_.assign(CHUNKSIZE, CHUNKSIZE);
+
+    auto it = spilled_.find(chunk.key_);
+    if (it == spilled_.end() || !restore(chunk, it->second)) {
+        release(chunk);
+        chunk.tiles_.assign(CHUNKTILES);
+        chunk.items_.assign(CHUNKSIZE, CHUNKSIZE);
+        generate_(static_cast<int>(chunk.key_ / chunkCols_),
+            static_cast<int>(chunk.key_ % chunkCols_), chunk.tiles_,
+            chunk.items_);
+    }
+
+    chunk.bytes_ = CHUNK_BYTES + chunk.items_.size() * ITEM_BYTES;
+    stats_.bytes += chunk.bytes_;
+}
+
+// Drops the least recently used chunk, saving it first if it has changed.
+bool ChunkStore::ChunkStoreImpl::evict() {
+    Chunk& chunk = chunks_.back();
+    if (chunk.changed_ && !spill(chunk)) {
+        return false;
+    }
+
+    release(chunk);
+    stats_.evictions++;
+    stats_.bytes -= chunk.bytes_;
+    index_.erase(chunk.key_);
+    chunks_.pop_back();
+    return true;
+}
+
+// A chunk is saved as a byte per tile (terrain plus the door, passable and
+// seen flags) followed by its items.  It goes back where it was last time
+// if it still fits.
+bool ChunkStore::ChunkStoreImpl::spill(Chunk& chunk) {
+    if (file_ == nullptr) {
+        file_ = std::tmpfile();
+        if (file_ == nullptr) {
+            return false;
+        }
+    }
+
+    std::ostringstream out;
+    for (std::size_t i = 0; i < CHUNKTILES; i++) {
+        out.put(static_cast<char>(static_cast<int>(chunk.tiles_.terrain(i)) |
+            chunk.tiles_.door(i) << 5 | chunk.tiles_.passable(i) << 6 |
+            chunk.tiles_.seen(i) << 7));
+    }
+    writeVarint(out, chunk.items_.size());
+    chunk.items_.foreach(0, 0, CHUNKSIZE, CHUNKSIZE,
+    [&](int row, int col, Entity item) {
+        writeVarint(out, local(row, col));
+        writeItem(out, *entities_, item);
+    });
+    buffer_ = out.str();
+
+    auto it = spilled_.find(chunk.key_);
+    Spilled spilled { 0, buffer_.size(), buffer_.size() };
+    if (it != spilled_.end() && it->second.capacity_ >= buffer_.size()) {
+        spilled.offset_ = it->second.offset_;
+        spilled.capacity_ = it->second.capacity_;
+    } else if (std::fseek(file_, 0, SEEK_END) == 0) {
+        spilled.offset_ = std::ftell(file_);
+    } else {
+        return false;
+    }
+
+    if (std::fseek(file_, spilled.offset_, SEEK_SET) != 0 ||
+    std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) {
+        return false;
+    }
+
+    spilled_[chunk.key_] = spilled;
+    stats_.spills++;
+    return true;
+}
+
+bool ChunkStore::ChunkStoreImpl::restore(Chunk& chunk,
+const Spilled& spilled) {
+    buffer_.resize(spilled.size_);
+    if (std::fseek(file_, spilled.offset_, SEEK_SET) != 0 ||
+    std::fread(&buffer_[0], 1, buffer_.size(), file_) != buffer_.size()) {
+        return false;
+    }
+
+    std::istringstream in(buffer_);
+    for (std::size_t i = 0; i < CHUNKTILES; i++) {
+        int c = in.get();
+        chunk.tiles_.setTerrain(i, static_cast<TERRAIN>(c & 0x1f));
+        chunk.tiles_.setDoor(i, c & 0x20);
+        chunk.tiles_.setPassable(i, c & 0x40);
+        chunk.tiles_.setSeen(i, c & 0x80);
+    }
+
+    int top = static_cast<int>(chunk.key_ / chunkCols_) * CHUNKSIZE;
+    int left = static_cast<int>(chunk.key_ % chunkCols_) * CHUNKSIZE;
+    std::uint64_t count = 0;
+    readVarint(in, count);
+    for (std::uint64_t n = 0; n < count; n++) {
+        std::uint64_t i = 0;
+        readVarint(in, i);
+        Entity item = readItem(in, *entities_);
+        if (item == NO_ENTITY) {
+            return false;
+        }
+        int row = static_cast<int>(i / CHUNKSIZE);
+        int col = static_cast<int>(i % CHUNKSIZE);
+        entities_->positions().insert(item, Position{top + row, left + col});
+        chunk.items_.insert(row, col, item);
+    }
+
+    stats_.restores++;
+    return true;
+}
+
+// Destroys the entities on a chunk which is being dropped or regenerated.
+void ChunkStore::ChunkStoreImpl::release(Chunk& chunk) {
+    chunk.items_.foreach(0, 0, CHUNKSIZE, CHUNKSIZE, [&](int, int, Entity item) {
+        entities_->destroy(item);
+    });
+    chunk.items_.assign(CHUNKSIZE, CHUNKSIZE);
+}
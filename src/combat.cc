@@ -1,63 +1,42 @@
-#include <cstdlib>
 #include "combat.h"
+#include "random.h"
 
-struct Combat::CombatImpl {
-    CombatImpl();
-    CombatImpl(int health, int offense, int defense);
-    ~CombatImpl()=default;
-
-    int         health_;
-    int         offense_;
-    int         defense_;
-};
-
-Combat::Combat() : impl_ { new Combat::CombatImpl() } {
-
+Combat::Combat() : Combat(0, 0, 0) {
 }
 
 Combat::Combat(int health, int offense, int defense) :
-    impl_ { new Combat::CombatImpl(health, offense, defense) } {
-
+health_{static_cast<std::int16_t>(health)},
+offense_{static_cast<std::int16_t>(offense)},
+defense_{static_cast<std::int16_t>(defense)} {
 }
 
-Combat::~Combat() {
-
+int Combat::attack(Random& rng) {
+    return rng.uniform(6) + rng.uniform(6) + offense_;
 }
 
-int Combat::attack() {
-    return rand() % 6 + rand() % 6 + impl_->offense_;
-}
-
-int Combat::defend() {
-    return rand() % 6 + rand() % 6 + impl_->defense_;
+int Combat::defend(Random& rng) {
+    return rng.uniform(6) + rng.uniform(6) + defense_;
 }
 
 int Combat::defense() const {
-    return impl_->defense_;
+    return defense_;
 }
 void Combat::setDefense(int defense) {
-    impl_->defense_ += defense;
+    defense_ += defense;
 }
 
 int Combat::health() const {
-    return impl_->health_;
+    return health_;
 }
 
 void Combat::setHealth(int health) {
-    impl_->health_ += health;
+    health_ += health;
 }
 
 int Combat::offense() const {
-    return impl_->offense_;
+    return offense_;
 }
 
 void Combat::setOffense(int offense) {
-    impl_->offense_ += offense;
-}
-
-Combat::CombatImpl::CombatImpl() : CombatImpl(0, 0, 0) {
-}
-
-Combat::CombatImpl::CombatImpl(int health, int offense, int defense) :
-health_{health}, offense_{offense}, defense_{defense} {
+    offense_ += offense;
 }
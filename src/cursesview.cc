@@ -0,0 +1,672 @@
+#include <algorithm>
+#include <clocale>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <string_view>
+#include <vector>
+
+#include <poll.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <curses.h>
+// These ncurses macros name clash with c++ symbols on old versions of ncurses
+#if NCURSES_MAJOR_VERSION < 5 || (NCURSES_MAJOR_VERSION == 5 && NCURSES_MINOR_VERSION < 9)
+#undef box
+#undef clear
+#undef erase
+#undef move
+#undef refresh
+#endif
+
+#include "cursesview.h"
+#include "item.h"
+#include "keymap.h"
+#include "messagelog.h"
+#include "terrain.h"
+
+struct WindowDeleter {
+    void operator()(WINDOW* window) {
+        delwin(window);
+    }
+};
+
+using WindowPtr = std::unique_ptr<WINDOW, WindowDeleter>;
+using TileMap = std::map<TERRAIN, chtype>;
+
+constexpr int TILEHEIGHT = 1;
+constexpr int TILEWIDTH  = 1;
+constexpr int VIEWPORTHEIGHT = 15;
+constexpr int VIEWPORTWIDTH  = 15;
+constexpr std::size_t MESSAGEWINHEIGHT = 15;
+
+// The cells of a window as they were last drawn and as they should look
+// now.  Everything is composed into next_ each frame and flush() only sends
+// the cells which differ.
+class Panel {
+public:
+    Panel() : window_{nullptr}, height_{0}, width_{0}, shown_{}, next_{} {}
+    Panel(const Panel&)=delete;
+    Panel& operator=(const Panel&)=delete;
+    ~Panel()=default;
+
+    void reset(WINDOW* window) {
+        window_ = window;
+        getmaxyx(window, height_, width_);
+        std::size_t size = static_cast<std::size_t>(height_) * width_;
+        shown_.assign(size, 0);
+        next_.assign(size, ' ');
+    }
+
+    // No cell is ever 0, so everything is sent next time.
+    void invalidate() {
+        std::fill(shown_.begin(), shown_.end(), 0);
+    }
+
+    void clear() {
+        std::fill(next_.begin(), next_.end(), ' ');
+    }
+
+    void put(int row, int col, chtype c) {
+        if (row >= 0 && row < height_ && col >= 0 && col < width_) {
+            next_[static_cast<std::size_t>(row) * width_ + col] = c;
+        }
+    }
+
+    void print(int row, int col, std::string_view text) {
+        for (std::size_t i = 0; i < text.size(); i++) {
+            put(row, col + static_cast<int>(i),
+                static_cast<unsigned char>(text[i]));
+        }
+    }
+
+    unsigned long flush() {
+        unsigned long cells = 0;
+        for (std::size_t i = 0; i < next_.size(); i++) {
+            if (next_[i] != shown_[i]) {
+                mvwaddch(window_, static_cast<int>(i / width_),
+                    static_cast<int>(i % width_), next_[i]);
+                shown_[i] = next_[i];
+                cells++;
+            }
+        }
+        if (cells > 0) {
+            wnoutrefresh(window_);
+        }
+        return cells;
+    }
+
+private:
+    WINDOW*             window_;
+    int                 height_;
+    int                 width_;
+    std::vector<chtype> shown_;
+    std::vector<chtype> next_;
+};
+
+// ncurses skips stdio and sends the terminal everything with write(2) on
+// stdout, so the program supplies its own write which counts those bytes on
+// the way past.
+static unsigned long terminalBytes = 0;
+
+extern "C" ssize_t write(int fd, const void* buf, size_t count) {
+    ssize_t written = syscall(SYS_write, fd, buf, count);
+    if (written > 0 && fd == STDOUT_FILENO) {
+        terminalBytes += static_cast<unsigned long>(written);
+    }
+    return written;
+}
+
+struct CursesView::ViewImpl {
+    ViewImpl();
+
+    ~ViewImpl()=default;
+
+    void    drawActors(World& world, int top, int left);
+    unsigned long drawBorders();
+    void    drawInventory(Player& player);
+    void    drawItems(World& world, int top, int left, int height, int width);
+    void    drawMessage();
+    void    drawTitle();
+    void    drawViewport(World& world);
+    void    invalidate();
+    int     nextKey(Game* game);
+    void    scrollMessages(long lines);
+    void    setTitleWin(WINDOW*& win);
+
+    static int  createTitleWin(WINDOW*, int);
+    static void end_sig(int);
+    static void finish();
+
+    // ncurses only supports one screen so the callbacks above act on
+    // whichever view was last initialized.
+    static ViewImpl* current_;
+
+    WindowPtr               inventory_;
+    WindowPtr               message_;
+    WindowPtr               title_;
+    WindowPtr               viewport_;
+    Keymap                  keymap_;
+    TileMap                 tilemap_;
+    int                     lines_;
+    int                     cols_;
+    std::size_t             messageWinWidth_;
+    sigset_t                waitMask_;
+    Scheduler               scheduler_;
+    std::string             titleText_;
+    MessageLog              messages_;
+    std::size_t             scrollBack_;
+    Panel                   inventoryCells_;
+    Panel                   messageCells_;
+    Panel                   titleCells_;
+    Panel                   viewportCells_;
+    bool                    layoutChanged_;
+    bool                    messagesChanged_;
+    FrameStats              stats_;
+};
+
+CursesView::ViewImpl* CursesView::ViewImpl::current_ = nullptr;
+
+CursesView::CursesView() : impl_ { new CursesView::ViewImpl() } {
+}
+
+CursesView::~CursesView() {
+
+}
+
+void CursesView::alert() {
+    beep();
+}
+
+// Each panel is composed from scratch but only the cells which changed
+// since the last frame are drawn, and if none did the terminal is left
+// alone.
+STATE CursesView::draw(World &world, Player &player) {
+    unsigned long cells = 0;
+    if (impl_->layoutChanged_) {
+        cells += impl_->drawBorders();
+    }
+
+    impl_->drawTitle();
+    impl_->drawViewport(world);
+    impl_->drawMessage();
+    impl_->drawInventory(player);
+    for (Panel* panel : { &impl_->titleCells_, &impl_->viewportCells_,
+    &impl_->messageCells_, &impl_->inventoryCells_ }) {
+        cells += panel->flush();
+    }
+
+    FrameStats& stats = impl_->stats_;
+    stats.frames++;
+    if (cells == 0) {
+        stats.skipped++;
+        return STATE::COMMAND;
+    }
+
+    unsigned long before = terminalBytes;
+    doupdate();
+    stats.lastCells = cells;
+    stats.lastBytes = terminalBytes - before;
+    stats.cells += stats.lastCells;
+    stats.bytes += stats.lastBytes;
+    return STATE::COMMAND;
+}
+
+void CursesView::end() {
+    ViewImpl::finish();
+}
+
+STATE CursesView::handleTopLevelInput(Game *game) {
+    return impl_->keymap_.command(impl_->nextKey(game), game);
+}
+
+DIRECTION CursesView::handleDirectionInput(Game* game) {
+    return impl_->keymap_.direction(impl_->nextKey(game));
+}
+
+int CursesView::handleNumericalInput(Game* game) {
+    int c = impl_->nextKey(game) - '0';
+    if (c > 0 || c <= 9) {
+        return c;
+    }
+    return 0;
+}
+
+bool CursesView::handleBooleanInput(Game* game) {
+    if (toupper(impl_->nextKey(game)) == 'Y') {
+        return true;
+    }
+    return false;
+}
+
+void CursesView::init(std::string titleText) {
+    std::setlocale(LC_ALL, "POSIX");
+
+    struct sigaction act;
+    act.sa_handler = CursesView::ViewImpl::end_sig;
+    sigemptyset (&act.sa_mask);
+    act.sa_flags = 0;
+    sigaction(SIGINT, &act, NULL);
+    sigaction(SIGSEGV, &act, NULL);
+
+    // SIGWINCH is only let through while waiting for input; see nextKey().
+    sigset_t winch;
+    sigemptyset(&winch);
+    sigaddset(&winch, SIGWINCH);
+    sigprocmask(SIG_BLOCK, &winch, &impl_->waitMask_);
+    sigdelset(&impl_->waitMask_, SIGWINCH);
+
+    impl_->titleText_ = titleText;
+
+    ViewImpl::current_ = impl_.get();
+    ripoffline(1, CursesView::ViewImpl::createTitleWin);
+    initscr();
+    cbreak();
+    noecho();
+    nonl();
+    keypad(stdscr, TRUE);
+    intrflush(stdscr, FALSE);
+    nodelay(stdscr, TRUE);
+
+    if (has_colors()) {
+        start_color();
+        init_pair(1, COLOR_BLACK, COLOR_WHITE);     // message/status window
+        init_pair(2, COLOR_WHITE, COLOR_BLACK);     // walls
+        init_pair(3, COLOR_BLACK,  COLOR_CYAN);     // title window
+        init_pair(4, COLOR_BLACK,  COLOR_BLACK);    // background
+        init_pair(5, COLOR_RED,  COLOR_BLACK);      // player and items
+        init_pair(6, COLOR_MAGENTA,   COLOR_BLACK); // monsters
+        init_pair(7, COLOR_GREEN,   COLOR_BLACK);  // doors
+    }
+
+    impl_->tilemap_[TERRAIN::EMPTY] = ' ';    //use of ACS_* requires this goes
+    impl_->tilemap_[TERRAIN::CORRIDOR] = '.'; // after call to initscr().
+    impl_->tilemap_[TERRAIN::FLOOR]    = '.';
+    impl_->tilemap_[TERRAIN::C_WALL]   = '+';
+    impl_->tilemap_[TERRAIN::H_WALL]   = ACS_HLINE;
+    impl_->tilemap_[TERRAIN::V_WALL]   = ACS_VLINE;
+    impl_->tilemap_[TERRAIN::UL_WALL]  = ACS_ULCORNER;
+    impl_->tilemap_[TERRAIN::UR_WALL]  = ACS_URCORNER;
+    impl_->tilemap_[TERRAIN::LR_WALL]  = ACS_LRCORNER;
+    impl_->tilemap_[TERRAIN::LL_WALL]  = ACS_LLCORNER;
+    impl_->tilemap_[TERRAIN::TT_WALL]  = ACS_TTEE;
+    impl_->tilemap_[TERRAIN::RT_WALL]  = ACS_RTEE;
+    impl_->tilemap_[TERRAIN::BT_WALL]  = ACS_BTEE;
+    impl_->tilemap_[TERRAIN::LT_WALL]  = ACS_LTEE;
+    impl_->tilemap_[TERRAIN::PLAYER]   = '@';
+    impl_->tilemap_[TERRAIN::H_DOOR_OPEN]   = '/';
+    impl_->tilemap_[TERRAIN::H_DOOR_CLOSED] = ACS_HLINE;
+    impl_->tilemap_[TERRAIN::V_DOOR_OPEN]   = '/';
+    impl_->tilemap_[TERRAIN::V_DOOR_CLOSED] = ACS_VLINE;
+    impl_->tilemap_[TERRAIN::TRAP]          = '^';
+}
+
+// A new message always brings the log back to the newest lines.
+void CursesView::message(std::string_view msg) {
+    impl_->messages_.add(msg);
+    impl_->scrollBack_ = 0;
+    impl_->messagesChanged_ = true;
+}
+
+void CursesView::pause(Game* game) {
+    while (impl_->nextKey(game) != ' ') {
+    }
+}
+
+void CursesView::refresh() {
+    clearok(curscr, TRUE);
+    impl_->invalidate();
+}
+
+void CursesView::resize(World& world) {
+    getmaxyx(stdscr, impl_->lines_, impl_->cols_);
+
+    wbkgd(stdscr, ' ');
+
+    // The viewport scrolls to follow the player around larger worlds.
+    int viewportHeight = std::min(world.height(), VIEWPORTHEIGHT);
+    int viewportWidth = std::min(world.width(), VIEWPORTWIDTH);
+    impl_->viewport_.reset(subwin(stdscr, viewportHeight, viewportWidth, 1, 5));
+    auto viewport = impl_->viewport_.get();
+    wbkgd(viewport, ' ' | COLOR_PAIR(4));
+
+
+    // COLS - left margin - right margin - sub window borders - viewport width
+    impl_->messageWinWidth_ = impl_->cols_ - 4 - 4 - 3  - VIEWPORTWIDTH;
+    impl_->messages_.setWidth(impl_->messageWinWidth_);
+    impl_->scrollBack_ = 0;
+    impl_->message_.reset(subwin(stdscr, VIEWPORTHEIGHT, impl_->messageWinWidth_,
+        1, 21));
+    auto message = impl_->message_.get();
+    wbkgd(message, ' ' | COLOR_PAIR(1));
+
+    impl_->inventory_.reset(subwin(stdscr, 5, impl_->cols_ - 4 - 4 - 2, 17, 5));
+    auto inventory = impl_->inventory_.get();
+    wbkgd(inventory, ' ' | COLOR_PAIR(1));
+
+    auto title = impl_->title_.get();
+    wresize(title, 1, impl_->cols_);
+    wbkgd(title, ' ' | COLOR_PAIR(3));
+
+    impl_->viewportCells_.reset(viewport);
+    impl_->messageCells_.reset(message);
+    impl_->inventoryCells_.reset(inventory);
+    impl_->titleCells_.reset(title);
+    impl_->invalidate();
+}
+
+void CursesView::shell() {
+    def_prog_mode();
+    endwin();
+    fprintf(stderr, "Type 'exit' to return.\n");
+    sigset_t blocked;
+    sigprocmask(SIG_SETMASK, &impl_->waitMask_, &blocked);
+    int returncode = system("/bin/sh");
+    sigprocmask(SIG_SETMASK, &blocked, NULL);
+    returncode += 0; // stops g++ warning for set but unused variable.
+    reset_prog_mode();
+    clearok(curscr, TRUE);
+    impl_->invalidate();
+}
+
+FrameStats CursesView::frameStats() const {
+    return impl_->stats_;
+}
+
+SchedulerStats CursesView::schedulerStats() const {
+    return impl_->scheduler_.stats();
+}
+
+// Lowering the frame rate, say for a player on a slow link, doesn't change
+// how fast the game ticks.
+void CursesView::setRates(unsigned ticksPerSecond, unsigned framesPerSecond) {
+    impl_->scheduler_.setTickRate(ticksPerSecond);
+    impl_->scheduler_.setFrameRate(framesPerSecond);
+}
+
+// Private methods
+
+CursesView::ViewImpl::ViewImpl() :
+inventory_{nullptr}, message_{nullptr}, title_{nullptr}, viewport_{nullptr},
+keymap_{},
+tilemap_{},
+lines_{0}, cols_{0}, messageWinWidth_{0}, waitMask_{}, scheduler_{},
+titleText_{""}, messages_{}, scrollBack_{0}, inventoryCells_{}, messageCells_{},
+titleCells_{}, viewportCells_{}, layoutChanged_{true}, messagesChanged_{true},
+stats_{} {
+    keymap_.bindCommand(KEY_RESIZE, &Game::resize);
+    keymap_.bindCommand(KEY_LEFT,   &Game::move_left);
+    keymap_.bindCommand(KEY_DOWN,   &Game::move_down);
+    keymap_.bindCommand(KEY_UP,     &Game::move_up);
+    keymap_.bindCommand(KEY_RIGHT,  &Game::move_right);
+    keymap_.bindCommand(KEY_HOME,   &Game::move_upleft);
+    keymap_.bindCommand(KEY_PPAGE,  &Game::move_upright);
+    keymap_.bindCommand(KEY_END,    &Game::move_downleft);
+    keymap_.bindCommand(KEY_NPAGE,  &Game::move_downright);
+
+    keymap_.bindDirection(KEY_LEFT,  DIRECTION::WEST);
+    keymap_.bindDirection(KEY_DOWN,  DIRECTION::SOUTH);
+    keymap_.bindDirection(KEY_UP,    DIRECTION::NORTH);
+    keymap_.bindDirection(KEY_RIGHT, DIRECTION::EAST);
+    keymap_.bindDirection(KEY_HOME,  DIRECTION::NORTHWEST);
+    keymap_.bindDirection(KEY_PPAGE, DIRECTION::NORTHEAST);
+    keymap_.bindDirection(KEY_END,   DIRECTION::SOUTHWEST);
+    keymap_.bindDirection(KEY_NPAGE, DIRECTION::SOUTHEAST);
+
+    keymap_.bindCommand(0x10 /* CTRL-P */, [this](Game*) {
+        scrollMessages(static_cast<long>(MESSAGEWINHEIGHT) - 1);
+        return STATE::COMMAND;
+    });
+    keymap_.bindCommand(0x0e /* CTRL-N */, [this](Game*) {
+        scrollMessages(1 - static_cast<long>(MESSAGEWINHEIGHT));
+        return STATE::COMMAND;
+    });
+}
+
+int CursesView::ViewImpl::createTitleWin(WINDOW* win, int /* ncols */) {
+    current_->setTitleWin(win);
+
+    return 0;
+}
+
+void CursesView::ViewImpl::drawActors(World& world, int top, int left) {
+    viewportCells_.put(world.playerRow() - top, world.playerCol() - left,
+        tilemap_[TERRAIN::PLAYER] | COLOR_PAIR(5) | A_BOLD);
+}
+
+// The borders only change when the layout does.
+unsigned long CursesView::ViewImpl::drawBorders() {
+    curs_set(0);
+    werase(stdscr);
+
+    mvhline(0, 4, ACS_CKBOARD, cols_ - 4 - 4);
+    mvvline(0, 4, ACS_CKBOARD, 23);
+    mvvline(0, 20, ACS_CKBOARD, 17);
+    mvvline(0, cols_ - 4 - 1, ACS_CKBOARD, 23);
+    mvhline(16, 4, ACS_CKBOARD, cols_ - 4 - 4);
+    mvhline(22, 4, ACS_CKBOARD, cols_ - 4 - 4);
+    wnoutrefresh(stdscr);
+
+    layoutChanged_ = false;
+    return static_cast<unsigned long>(lines_) * cols_;
+}
+
+void CursesView::ViewImpl::drawInventory(Player& player) {
+    char buffer[80];
+    inventoryCells_.clear();
+    inventoryCells_.print(0, 5, "wielding");
+    inventoryCells_.print(0, 30, "carrying");
+    std::snprintf(buffer, sizeof buffer, "stamina: %02d", player.health());
+    inventoryCells_.print(0, 55, buffer);
+    int row = 1;
+    int key = 1;
+    auto print = [&](int col, Item item) {
+        std::snprintf(buffer, sizeof buffer, "%d ", key++);
+        inventoryCells_.print(row, col, buffer);
+        col += static_cast<int>(std::strlen(buffer));
+        if (!item) {
+            inventoryCells_.print(row++, col, "nothing");
+            return;
+        }
+        std::string_view article = item.article();
+        inventoryCells_.print(row, col, article);
+        col += static_cast<int>(article.size()) + 1;
+        inventoryCells_.print(row++, col, item.name());
+    };
+    player.foreach_wielded([&](Item item) { print(5, item); });
+    row = 1;
+    player.foreach_carried([&](Item item) { print(30, item); });
+}
+
+void CursesView::ViewImpl::drawItems(World& world, int top, int left,
+int height, int width) {
+    world.foreach_item(top, left, height, width, [&](int row, int col, Item item) {
+        chtype t;
+
+        Tile tile = world.tileAt(row, col);
+        if (tile.visible() == false && tile.seen() == false) {
+            t = tilemap_[TERRAIN::EMPTY];
+            viewportCells_.put(row - top, col - left, t);
+            return;
+        }
+
+        switch(item.type()) {
+            case ITEMTYPE::DOOR: {
+                    const DoorState* d = item.door();
+                    if (d->open) {
+                        t = (d->horizontal) ? tilemap_[TERRAIN::H_DOOR_OPEN] | COLOR_PAIR(7)
+                            : tilemap_[TERRAIN::V_DOOR_OPEN] | COLOR_PAIR(7);
+                    } else {
+                        t = (d->horizontal) ? tilemap_[TERRAIN::H_DOOR_CLOSED] | COLOR_PAIR(7)
+                            : tilemap_[TERRAIN::V_DOOR_CLOSED] | COLOR_PAIR(7);
+                    }
+                }
+                break;
+            case ITEMTYPE::TRAP: {
+                    if (item.trap()->sprung) {
+                        t = tilemap_[TERRAIN::TRAP]  | COLOR_PAIR(5);
+                    } else {
+                        t = tilemap_[TERRAIN::FLOOR] | COLOR_PAIR(2);
+                    }
+
+                }
+                break;
+            default: {
+                    const Archetype& archetype = item.archetype();
+                    t = static_cast<unsigned char>(archetype.glyph) |
+                        ((archetype.flags & MONSTER) ? COLOR_PAIR(6) : COLOR_PAIR(5));
+                }
+                break;
+        }
+
+        if (tile.visible()) {
+            t |= A_BOLD;
+        }
+        viewportCells_.put(row - top, col - left, t);
+    });
+}
+
+// Messages are only composed again when there is a new one.
+void CursesView::ViewImpl::drawMessage() {
+    if (!messagesChanged_) {
+        return;
+    }
+
+    messageCells_.clear();
+    std::size_t shown = std::min(messages_.lines() - scrollBack_,
+        MESSAGEWINHEIGHT);
+    for (std::size_t row = 0; row < shown; row++) {
+        messageCells_.print(static_cast<int>(row), 0,
+            messages_.line(scrollBack_ + shown - 1 - row));
+    }
+    messagesChanged_ = false;
+}
+
+void CursesView::ViewImpl::drawTitle() {
+    const int len = titleText_.length();
+    titleCells_.clear();
+    titleCells_.print(0, (cols_ - len)/2, titleText_);
+}
+
+void CursesView::ViewImpl::drawViewport(World &world) {
+    int screenHeight, screenWidth;
+    getmaxyx(viewport_.get(), screenHeight, screenWidth);
+
+    int playerCol = world.playerCol();
+    int playerRow = world.playerRow();
+    int worldHeight = world.height();
+    int worldWidth  = world.width();
+
+    int top = playerRow - (screenHeight) / 2;
+    int left = playerCol - (screenWidth) / 2;
+
+    viewportCells_.clear();
+    for (int row = 0; row < screenHeight; row += TILEHEIGHT) {
+        int mapRow = row + top;
+
+        if (mapRow < world.firstRow() || mapRow >= worldHeight) {
+            continue;
+        }
+
+        for (int  col = 0; col < screenWidth; col += TILEWIDTH) {
+            int mapCol = col + left;
+
+            if (mapCol < 0 || mapCol >= worldWidth) {
+                continue;
+            }
+
+            chtype display;
+            Tile t = world.tileAt(mapRow, mapCol);
+
+            if (t.visible() == false && t.seen() == false) {
+                display = tilemap_[TERRAIN::EMPTY];
+                viewportCells_.put(row, col, display);
+                continue;
+            } else {
+                display = tilemap_[t.terrain()];
+
+                if (t.isBlock()) {
+                    display |= COLOR_PAIR(2);
+                }
+            }
+            if (t.visible()) {
+                display |= A_BOLD;
+            }
+            viewportCells_.put(row, col, display);
+        }
+    }
+
+    drawItems(world, top, left, screenHeight, screenWidth);
+
+    drawActors(world, top, left);
+}
+
+// Everything is sent again on the next frame, borders included.
+void CursesView::ViewImpl::invalidate() {
+    for (Panel* panel : { &titleCells_, &viewportCells_, &messageCells_,
+    &inventoryCells_ }) {
+        panel->invalidate();
+    }
+    messagesChanged_ = true;
+    layoutChanged_ = true;
+}
+
+void CursesView::ViewImpl::end_sig(int /* sig */) {
+    finish();
+}
+
+void CursesView::ViewImpl::finish() {
+    curs_set(1);
+    endwin();
+    clear();
+    exit(EXIT_SUCCESS);
+}
+
+// Sleeps in ppoll() on the terminal until a key arrives, running game ticks
+// and frames as the scheduler says meanwhile.  Whatever a key did is drawn
+// as soon as the game asks for the next one.  SIGWINCH is blocked everywhere
+// else so a resize can't slip in between getch() and ppoll(); it interrupts
+// the wait and ncurses then hands getch() a KEY_RESIZE.  A terminal that
+// hangs up ends the game.
+int CursesView::ViewImpl::nextKey(Game* game) {
+    pollfd terminal = { STDIN_FILENO, POLLIN, 0 };
+
+    while (true) {
+        int c = getch();
+        if (c != ERR) {
+            scheduler_.requestFrame();
+            return c;
+        }
+        std::uint64_t wait = scheduler_.advance(Scheduler::now(),
+            [game]() { game->tick(); }, [game]() { game->draw(); });
+        const timespec timeout = {
+            static_cast<time_t>(wait / 1000000000),
+            static_cast<long>(wait % 1000000000)
+        };
+        if (ppoll(&terminal, 1, &timeout, &waitMask_) > 0 &&
+        (terminal.revents & (POLLHUP | POLLERR | POLLNVAL))) {
+            finish();
+        }
+    }
+}
+
+// Positive is back towards older messages.  The oldest screenful is as far
+// back as it goes.
+void CursesView::ViewImpl::scrollMessages(long lines) {
+    long oldest = static_cast<long>(messages_.lines()) -
+        static_cast<long>(MESSAGEWINHEIGHT);
+    long back = static_cast<long>(scrollBack_) + lines;
+    scrollBack_ = static_cast<std::size_t>(
+        std::max(0L, std::min(back, std::max(oldest, 0L))));
+    messagesChanged_ = true;
+}
+
+void CursesView::ViewImpl::setTitleWin(WINDOW*& win) {
+
+    title_.reset(win);
+}
@@ -0,0 +1,129 @@
+#include "entities.h"
+#include "item.h"
+
+Entities::Entities() : archetypes_{}, free_{}, actors_{}, armaments_{},
+combat_{}, doors_{}, positions_{}, traps_{} {
+}
+
+// A new entity gets the components its archetype calls for, with the
+// archetype's starting values.  It is put on the map separately.
+Entity Entities::create(ARCHETYPE archetype) {
+    Entity entity;
+    if (free_.empty()) {
+        entity = static_cast<Entity>(archetypes_.size());
+        archetypes_.push_back(archetype);
+    } else {
+        entity = free_.back();
+        free_.pop_back();
+        archetypes_[entity] = archetype;
+    }
+
+    const Archetype& kind = ::archetype(archetype);
+    if (kind.type == ITEMTYPE::DOOR) {
+        doors_.insert(entity, DoorState{false, false});
+    } else if (kind.type == ITEMTYPE::TRAP) {
+        traps_.insert(entity, TrapState{false});
+    } else if (kind.flags & MONSTER) {
+        combat_.insert(entity, Combat(kind.health, kind.offense,
+            kind.defense));
+    } else if (kind.flags & WIELDABLE) {
+        armaments_.insert(entity, Armament(kind.defense, kind.offense));
+    }
+
+    return entity;
+}
+
+void Entities::destroy(Entity entity) {
+    if (!alive(entity)) {
+        return;
+    }
+    actors_.erase(entity);
+    armaments_.erase(entity);
+    combat_.erase(entity);
+    doors_.erase(entity);
+    positions_.erase(entity);
+    traps_.erase(entity);
+    archetypes_[entity] = ARCHETYPE::NOTHING;
+    free_.push_back(entity);
+}
+
+void Entities::clear() {
+    archetypes_.clear();
+    free_.clear();
+    actors_.clear();
+    armaments_.clear();
+    combat_.clear();
+    doors_.clear();
+    positions_.clear();
+    traps_.clear();
+}
+
+bool Entities::alive(Entity entity) const {
+    return entity < archetypes_.size() &&
+        archetypes_[entity] != ARCHETYPE::NOTHING;
+}
+
+ARCHETYPE Entities::archetype(Entity entity) const {
+    return entity < archetypes_.size() ? archetypes_[entity] :
+        ARCHETYPE::NOTHING;
+}
+
+std::size_t Entities::size() const {
+    return archetypes_.size() - free_.size();
+}
+
+// Heap bytes held by the store, counting room reserved for growth.
+std::size_t Entities::bytes() const {
+    return archetypes_.capacity() * sizeof(ARCHETYPE) +
+        free_.capacity() * sizeof(Entity) + actors_.bytes() +
+        armaments_.bytes() + combat_.bytes() + doors_.bytes() +
+        positions_.bytes() + traps_.bytes();
+}
+
+SparseSet<Actor>& Entities::actors() {
+    return actors_;
+}
+
+const SparseSet<Actor>& Entities::actors() const {
+    return actors_;
+}
+
+SparseSet<Armament>& Entities::armaments() {
+    return armaments_;
+}
+
+const SparseSet<Armament>& Entities::armaments() const {
+    return armaments_;
+}
+
+SparseSet<Combat>& Entities::combat() {
+    return combat_;
+}
+
+const SparseSet<Combat>& Entities::combat() const {
+    return combat_;
+}
+
+SparseSet<DoorState>& Entities::doors() {
+    return doors_;
+}
+
+const SparseSet<DoorState>& Entities::doors() const {
+    return doors_;
+}
+
+SparseSet<Position>& Entities::positions() {
+    return positions_;
+}
+
+const SparseSet<Position>& Entities::positions() const {
+    return positions_;
+}
+
+SparseSet<TrapState>& Entities::traps() {
+    return traps_;
+}
+
+const SparseSet<TrapState>& Entities::traps() const {
+    return traps_;
+}
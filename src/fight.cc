@@ -0,0 +1,187 @@
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "fight.h"
+#include "item.h"
+#include "random.h"
+
+// What can happen in a round, as weights out of ROLLS * ROLLS.  A round in
+// which neither side hits changes nothing, so a fight is a walk through only
+// the rounds in which something happens, with the quiet ones in between
+// counted separately.
+struct Round {
+    explicit Round(const Bout& bout);
+
+    // What a round in which the player ends up having taken taken hits and
+    // dealt dealt, with the monster having hit this round if hit, leads to.
+    // COUNT means the fight goes on.
+    ENDING ending(int taken, int dealt, bool hit) const;
+
+    std::uint32_t monster;  // only the monster hits
+    std::uint32_t both;     // both hit
+    std::uint32_t player;   // only the player hits
+    std::uint32_t any;      // either hits
+    std::uint32_t quiet;    // neither hits
+    int           lives;    // hits the player can take before dying
+    int           health;   // hits the monster can take before dying
+    bool          teleports;
+};
+
+Round::Round(const Bout& bout) : monster{0}, both{0}, player{0}, any{0},
+quiet{0},
+lives{(std::max(bout.playerHealth, 1) + bout.damage - 1) / bout.damage},
+health{std::max(bout.monsterHealth, 1)}, teleports{bout.teleports} {
+    std::uint32_t a = static_cast<std::uint32_t>(hits(bout.monsterOffense,
+        bout.playerDefense));
+    std::uint32_t b = static_cast<std::uint32_t>(hits(bout.playerOffense,
+        bout.monsterDefense));
+    monster = a * (ROLLS - b);
+    both = a * b;
+    player = (ROLLS - a) * b;
+    any = monster + both + player;
+    quiet = (ROLLS - a) * (ROLLS - b);
+}
+
+ENDING Round::ending(int taken, int dealt, bool hit) const {
+    bool dead = taken >= lives;
+    bool killed = dealt >= health;
+    if (dead && killed) {
+        return ENDING::BOTH;
+    }
+    if (dead) {
+        return ENDING::LOST;
+    }
+    if (killed) {
+        return ENDING::WON;
+    }
+    return hit && teleports ? ENDING::TELEPORTED : ENDING::COUNT;
+}
+
+// The player's side is their own stats plus what they are wielding.  A
+// dragon's hit costs three health and a wizard's teleports.
+Bout bout(const Combat& player, int offenseBonus, int defenseBonus,
+const Combat& monster, ITEMTYPE type) {
+    return Bout{player.health(), player.offense() + offenseBonus,
+        player.defense() + defenseBonus, monster.health(), monster.offense(),
+        monster.defense(), type == ITEMTYPE::DRAGON ? 3 : 1,
+        type == ITEMTYPE::WIZARD};
+}
+
+// Goes through the hits taken and dealt so far in order, carrying the
+// chance of getting to each on to the ones which can follow it, so it takes
+// lives * health steps however long the fight could go on.
+Odds odds(const Bout& bout) {
+    Odds result{};
+    Round round(bout);
+    if (round.any == 0) {
+        result.endings[static_cast<std::size_t>(ENDING::STALEMATE)] = 1;
+        result.rounds = 1;
+        return result;
+    }
+
+    double total = round.any;
+    const std::array<std::pair<int, int>, 3> steps = {
+        std::pair{1, 0}, std::pair{1, 1}, std::pair{0, 1}
+    };
+    const std::array<double, 3> chances = {
+        round.monster / total, round.both / total, round.player / total
+    };
+    std::vector<double> reach(static_cast<std::size_t>(round.lives) *
+        static_cast<std::size_t>(round.health), 0.0);
+    reach[0] = 1;
+    double moves = 0;
+    for (int taken = 0; taken < round.lives; taken++) {
+        for (int dealt = 0; dealt < round.health; dealt++) {
+            double here = reach[static_cast<std::size_t>(taken * round.health +
+                dealt)];
+            if (here == 0) {
+                continue;
+            }
+            moves += here;
+            for (std::size_t i = 0; i < steps.size(); i++) {
+                int t = taken + steps[i].first;
+                int d = dealt + steps[i].second;
+                double chance = here * chances[i];
+                ENDING ending = round.ending(t, d, steps[i].first != 0);
+                if (ending == ENDING::COUNT) {
+                    reach[static_cast<std::size_t>(t * round.health + d)] +=
+                        chance;
+                } else {
+                    result.endings[static_cast<std::size_t>(ending)] += chance;
+                    result.damage += chance * t * bout.damage;
+                }
+            }
+        }
+    }
+
+    // Each round something happens in takes ROLLS * ROLLS / any rounds on
+    // average.
+    result.rounds = moves * static_cast<double>(ROLLS) * ROLLS / total;
+    return result;
+}
+
+// Takes a step per round in which something happens, each picked with its
+// exact weight, and works out how many quiet rounds came before it by
+// inverting their geometric distribution.  So a fight costs at most lives +
+// health draws however many rounds it lasts.
+Fight fight(const Bout& bout, Random& rng) {
+    Fight result{ENDING::STALEMATE, 1, 0, 0};
+    Round round(bout);
+    if (round.any == 0) {
+        return result;
+    }
+
+    double stay = std::log(static_cast<double>(round.quiet) /
+        (static_cast<double>(ROLLS) * ROLLS));
+    result.rounds = 0;
+    for (;;) {
+        result.rounds++;
+        if (round.quiet != 0) {
+            double u = std::ldexp(static_cast<double>((rng.next() >> 11) + 1),
+                -53);
+            result.rounds += static_cast<unsigned long>(std::log(u) / stay);
+        }
+
+        std::uint32_t roll = rng.uniform(round.any);
+        bool hit = roll < round.monster + round.both;
+        result.taken += hit;
+        result.dealt += roll >= round.monster;
+        result.ending = round.ending(result.taken, result.dealt, hit);
+        if (result.ending != ENDING::COUNT) {
+            return result;
+        }
+    }
+}
+
+// Every monster against every way of filling the player's two hands, with
+// the same thing twice allowed and the order not mattering.
+std::vector<Matchup> matchups(const Combat& player) {
+    std::vector<ARCHETYPE> wieldable = { ARCHETYPE::NOTHING };
+    for (std::size_t i = 0; i < static_cast<std::size_t>(ARCHETYPE::COUNT);
+    i++) {
+        if (archetype(static_cast<ARCHETYPE>(i)).flags & WIELDABLE) {
+            wieldable.push_back(static_cast<ARCHETYPE>(i));
+        }
+    }
+
+    std::vector<Matchup> result;
+    for (std::size_t i = 0; i < static_cast<std::size_t>(ARCHETYPE::COUNT);
+    i++) {
+        const Archetype& kind = archetype(static_cast<ARCHETYPE>(i));
+        if (!(kind.flags & MONSTER)) {
+            continue;
+        }
+        Combat monster(kind.health, kind.offense, kind.defense);
+        for (std::size_t a = 0; a < wieldable.size(); a++) {
+            for (std::size_t b = a; b < wieldable.size(); b++) {
+                const Archetype& first = archetype(wieldable[a]);
+                const Archetype& second = archetype(wieldable[b]);
+                Bout matched = bout(player, first.offense + second.offense,
+                    first.defense + second.defense, monster, kind.type);
+                result.push_back(Matchup{static_cast<ARCHETYPE>(i),
+                    { wieldable[a], wieldable[b] }, odds(matched)});
+            }
+        }
+    }
+    return result;
+}
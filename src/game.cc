@@ -1,55 +1,104 @@
+#include <algorithm>
 #include <cstdlib>
-#include <ctime>
+#include <random>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
-#include "armament.h"
 #include "direction.h"
-#include "door.h"
+#include "fight.h"
 #include "game.h"
 #include "item.h"
-#include "key.h"
-#include "monster.h"
+#include "monsters.h"
+#include "pathing.h"
 #include "player.h"
-#include "potion.h"
-#include "trap.h"
+#include "random.h"
 #include "view.h"
 #include "world.h"
 
-struct Game::GameImpl {
-    GameImpl();
-    std::string name_;
-    std::string version_;
+// The most steps one command takes.
+static constexpr unsigned long MAX_WALK = 1000;
 
+struct Game::GameImpl {
+    explicit GameImpl(std::unique_ptr<View> view);
+    std::string           name_;
+    std::string           version_;
+    unsigned long         turns_;
+    unsigned long         ticks_;
+    int                   height_;
+    int                   width_;
+    std::uint64_t         seed_;
+    MAZE                  maze_;
+    bool                  endless_;
+    std::size_t           chunkBudget_;
+    int                   fovRadius_;
+    bool                  hunting_;
+    Random                combat_;
+    World                 world_;
+    Player                player_;
+    Pathing               pathing_;
+    Monsters              monsters_;
+    Entity                engaged_;
+    std::unique_ptr<View> view_;
+
+    STATE acted(STATE state);
+    void  look();
+    std::vector<Entity> monstersInView();
+    STATE walk(const std::vector<Position>& path,
+        const std::vector<Entity>& known, std::string& why);
+    STATE explore();
+    STATE travel(std::function<bool(int, int)> goal);
+    std::vector<Entity> itemsAround(int row, int col);
+    void  plan(std::vector<Position>& path, std::string& stop);
+    STATE run();
     bool canMove(int row, int col);
     STATE fight();
-    STATE fightHere(int row, int col, Monster*& monster);
+    STATE fightHere(int row, int col, Item monster);
+    STATE fightToDeath();
+    STATE fightOut(int row, int col, Item monster);
     STATE batter();
     STATE close();
     STATE open();
     STATE move();
     STATE take();
-    STATE takeHere(int row, int col, Item*& item);
-    STATE directed(std::string command, std::function<STATE(GameImpl&)> func);
+    STATE takeHere(int row, int col, Item item);
+    STATE directed(Game* game, std::string command,
+        std::function<STATE(GameImpl&)> func);
+};
+
+Game::Game(std::unique_ptr<View> view) :
+    impl_ { new Game::GameImpl(std::move(view)) } {
+}
 
-} Game::impl_;
+Game::~Game() {
 
-static Player player;
-static View view;
-static World world;
+}
 
 int Game::run(const char *name, const char *version) {
-    std::srand(std::time(NULL));
-
-    impl_.name_ = name;
-    impl_.version_ = version;
+    impl_->name_ = name;
+    impl_->version_ = version;
 
     STATE state = STATE::COMMAND;
     bool running = true;
 
-    world.create();
+    // Generation and combat each get their own stream so that fighting can't
+    // change the levels a seed produces.
+    Random streams(impl_->seed_);
+    if (impl_->endless_) {
+        impl_->world_.createEndless(impl_->width_, streams.next());
+    } else if (impl_->chunkBudget_ > 0) {
+        impl_->world_.createChunked(impl_->height_, impl_->width_,
+            streams.next(), impl_->maze_, impl_->chunkBudget_);
+    } else {
+        impl_->world_.create(impl_->height_, impl_->width_, streams.next(),
+            impl_->maze_);
+    }
+    impl_->combat_ = streams.split();
+    impl_->world_.setFovRadius(impl_->fovRadius_);
 
-    view.init(impl_.name_);
+    impl_->view_->init(impl_->name_);
     resize();
 
     Game::version();
@@ -57,13 +106,16 @@ int Game::run(const char *name, const char *version) {
     while (running) {
         switch(state) {
         case STATE::COMMAND:
-            state = view.handleTopLevelInput(this);
+            state = impl_->view_->handleTopLevelInput(this);
+            impl_->turns_++;
             break;
         case STATE::FIGHTING:
-            state = impl_.fight();
+            state = impl_->fight();
+            impl_->turns_++;
             break;
         case STATE::MOVING:
-            state = impl_.move();
+            state = impl_->move();
+            impl_->turns_++;
             break;
         case STATE::DEAD:
             state = dead();
@@ -78,241 +130,340 @@ int Game::run(const char *name, const char *version) {
         }
     }
 
-    view.end();
+    impl_->view_->end();
 
-    // Actually we won't ever get here because view.end() exit(3)s.
+    // A CursesView won't ever get here because its end() exit(3)s.
     return EXIT_SUCCESS;
 }
 
+unsigned long Game::turns() const {
+    return impl_->turns_;
+}
+
+unsigned long Game::ticks() const {
+    return impl_->ticks_;
+}
+
+std::uint64_t Game::seed() const {
+    return impl_->seed_;
+}
+
+void Game::setSeed(std::uint64_t seed) {
+    impl_->seed_ = seed;
+}
+
+void Game::setWorldSize(int height, int width) {
+    impl_->height_ = height;
+    impl_->width_ = width;
+}
+
+void Game::setMaze(MAZE maze) {
+    impl_->maze_ = maze;
+}
+
+void Game::setEndless(bool endless) {
+    impl_->endless_ = endless;
+}
+
+void Game::setChunkBudget(std::size_t bytes) {
+    impl_->chunkBudget_ = bytes;
+}
+
+void Game::setFovRadius(int radius) {
+    impl_->fovRadius_ = radius;
+}
+
+void Game::setHunting(bool hunting) {
+    impl_->hunting_ = hunting;
+}
+
 STATE Game::badInput() {
-    view.message("Huh?");
+    impl_->view_->message("Huh?");
     return STATE::ERROR;
 }
 
 STATE Game::dead() {
-    view.message("--press space to continue--");
-    view.pause(this);
+    impl_->view_->message("--press space to continue--");
+    impl_->view_->pause(this);
     return STATE::QUIT;
 }
 
 void Game::draw() {
-    world.fov();
-    view.draw(world, player);
+    impl_->look();
+    impl_->view_->draw(impl_->world_, impl_->player_);
+}
+
+// Called by the view at a fixed rate of wall clock time, however often the
+// screen is drawn.  Nothing in the game happens in real time yet, so this
+// only keeps count.
+void Game::tick() {
+    impl_->ticks_++;
 }
 
 STATE Game::error() {
-    view.alert();
+    impl_->view_->alert();
 
     return STATE::COMMAND;
 }
 
 STATE Game::fight() {
-    player.setKeepFighting(false);
-    return impl_.directed("fight", &GameImpl::fight);
+    impl_->player_.setKeepFighting(false);
+    return impl_->directed(this, "fight", &GameImpl::fight);
 }
 
 STATE Game::fightToDeath() {
-    player.setKeepFighting(true);
-    return impl_.directed("fight to the death", &GameImpl::fight);
+    impl_->player_.setKeepFighting(true);
+    return impl_->directed(this, "fight to the death",
+        &GameImpl::fightToDeath);
 }
 
 STATE Game::move_left() {
-    player.setFacingY(0);
-    player.setFacingX(-1);
-    player.setPickup(true);
-    player.setKeepMoving(false);
+    impl_->player_.setFacingY(0);
+    impl_->player_.setFacingX(-1);
+    impl_->player_.setPickup(true);
+    impl_->player_.setKeepMoving(false);
     return STATE::MOVING;
 }
 
 STATE Game::move_down() {
-    player.setFacingY(1);
-    player.setFacingX(0);
-    player.setPickup(true);
-    player.setKeepMoving(false);
+    impl_->player_.setFacingY(1);
+    impl_->player_.setFacingX(0);
+    impl_->player_.setPickup(true);
+    impl_->player_.setKeepMoving(false);
     return STATE::MOVING;
 }
 
 STATE Game::move_up() {
-    player.setFacingY(-1);
-    player.setFacingX(0);
-    player.setPickup(true);
-    player.setKeepMoving(false);
+    impl_->player_.setFacingY(-1);
+    impl_->player_.setFacingX(0);
+    impl_->player_.setPickup(true);
+    impl_->player_.setKeepMoving(false);
     return STATE::MOVING;
 }
 
 STATE Game::move_right() {
-    player.setFacingY(0);
-    player.setFacingX(1);
-    player.setPickup(true);
-    player.setKeepMoving(false);
+    impl_->player_.setFacingY(0);
+    impl_->player_.setFacingX(1);
+    impl_->player_.setPickup(true);
+    impl_->player_.setKeepMoving(false);
     return STATE::MOVING;
 }
 
 STATE Game::move_upleft() {
-    player.setFacingY(-1);
-    player.setFacingX(-1);
-    player.setPickup(true);
-    player.setKeepMoving(false);
+    impl_->player_.setFacingY(-1);
+    impl_->player_.setFacingX(-1);
+    impl_->player_.setPickup(true);
+    impl_->player_.setKeepMoving(false);
     return STATE::MOVING;
 }
 
 STATE Game::move_upright() {
-    player.setFacingY(-1);
-    player.setFacingX(1);
-    player.setPickup(true);
-    player.setKeepMoving(false);
+    impl_->player_.setFacingY(-1);
+    impl_->player_.setFacingX(1);
+    impl_->player_.setPickup(true);
+    impl_->player_.setKeepMoving(false);
     return STATE::MOVING;
 }
 
 STATE Game::move_downleft() {
-    player.setFacingY(1);
-    player.setFacingX(-1);
-    player.setPickup(true);
-    player.setKeepMoving(false);
+    impl_->player_.setFacingY(1);
+    impl_->player_.setFacingX(-1);
+    impl_->player_.setPickup(true);
+    impl_->player_.setKeepMoving(false);
     return STATE::MOVING;
 }
 
 STATE Game::move_downright() {
-    player.setFacingY(1);
-    player.setFacingX(1);
-    player.setPickup(true);
-    player.setKeepMoving(false);
+    impl_->player_.setFacingY(1);
+    impl_->player_.setFacingX(1);
+    impl_->player_.setPickup(true);
+    impl_->player_.setKeepMoving(false);
     return STATE::MOVING;
 }
 
 STATE Game::run_left() {
-    player.setFacingY(0);
-    player.setFacingX(-1);
-    player.setPickup(true);
-    player.setKeepMoving(true);
-    return STATE::MOVING;
+    impl_->player_.setFacingY(0);
+    impl_->player_.setFacingX(-1);
+    impl_->player_.setPickup(true);
+    impl_->player_.setKeepMoving(false);
+    return impl_->run();
 }
 
 STATE Game::run_down() {
-    player.setFacingY(1);
-    player.setFacingX(0);
-    player.setPickup(true);
-    player.setKeepMoving(true);
-    return STATE::MOVING;
+    impl_->player_.setFacingY(1);
+    impl_->player_.setFacingX(0);
+    impl_->player_.setPickup(true);
+    impl_->player_.setKeepMoving(false);
+    return impl_->run();
 }
 
 STATE Game::run_up() {
-    player.setFacingY(-1);
-    player.setFacingX(0);
-    player.setPickup(true);
-    player.setKeepMoving(true);
-    return STATE::MOVING;
+    impl_->player_.setFacingY(-1);
+    impl_->player_.setFacingX(0);
+    impl_->player_.setPickup(true);
+    impl_->player_.setKeepMoving(false);
+    return impl_->run();
 }
 
 STATE Game::run_right() {
-    player.setFacingY(0);
-    player.setFacingX(1);
-    player.setPickup(true);
-    player.setKeepMoving(true);
-    return STATE::MOVING;
+    impl_->player_.setFacingY(0);
+    impl_->player_.setFacingX(1);
+    impl_->player_.setPickup(true);
+    impl_->player_.setKeepMoving(false);
+    return impl_->run();
 }
 
 STATE Game::run_upleft() {
-    player.setFacingY(-1);
-    player.setFacingX(-1);
-    player.setPickup(true);
-    player.setKeepMoving(true);
-    return STATE::MOVING;
+    impl_->player_.setFacingY(-1);
+    impl_->player_.setFacingX(-1);
+    impl_->player_.setPickup(true);
+    impl_->player_.setKeepMoving(false);
+    return impl_->run();
 }
 
 STATE Game::run_upright() {
-    player.setFacingY(-1);
-    player.setFacingX(1);
-    player.setPickup(true);
-    player.setKeepMoving(true);
-    return STATE::MOVING;
+    impl_->player_.setFacingY(-1);
+    impl_->player_.setFacingX(1);
+    impl_->player_.setPickup(true);
+    impl_->player_.setKeepMoving(false);
+    return impl_->run();
 }
 
 STATE Game::run_downleft() {
-    player.setFacingY(1);
-    player.setFacingX(-1);
-    player.setPickup(true);
-    player.setKeepMoving(true);
-    return STATE::MOVING;
+    impl_->player_.setFacingY(1);
+    impl_->player_.setFacingX(-1);
+    impl_->player_.setPickup(true);
+    impl_->player_.setKeepMoving(false);
+    return impl_->run();
 }
 
 STATE Game::run_downright() {
-    player.setFacingY(1);
-    player.setFacingX(1);
-    player.setPickup(true);
-    player.setKeepMoving(true);
-    return STATE::MOVING;
+    impl_->player_.setFacingY(1);
+    impl_->player_.setFacingX(1);
+    impl_->player_.setPickup(true);
+    impl_->player_.setKeepMoving(false);
+    return impl_->run();
 }
 
 STATE Game::moveOver() {
-    player.setPickup(false);
-    return impl_.directed("move over", &GameImpl::move);
+    impl_->player_.setPickup(false);
+    return impl_->directed(this, "move over", &GameImpl::move);
 }
 
 STATE Game::runOver() {
-    player.setKeepMoving(true);
-    player.setPickup(false);
-    return impl_.directed("run over", &GameImpl::move);
+    impl_->player_.setKeepMoving(false);
+    impl_->player_.setPickup(false);
+    return impl_->directed(this, "run over", &GameImpl::run);
+}
+
+STATE Game::explore() {
+    return impl_->explore();
+}
+
+STATE Game::travelToStart() {
+    int row = 0;
+    int col = impl_->world_.startCol();
+    return impl_->travel([row, col](int r, int c) {
+        return r == row && c == col;
+    });
+}
+
+STATE Game::travelToExit() {
+    World& world = impl_->world_;
+    int row = world.height() - 1;
+    int col = world.endCol();
+    if (world.endless() || !world.tileAt(row, col).seen()) {
+        impl_->view_->message("You haven't found the way out.");
+        return STATE::ERROR;
+    }
+    return impl_->travel([row, col](int r, int c) {
+        return r == row && c == col;
+    });
+}
+
+// To the nearest closed door that has been seen, other than any the player
+// is already standing next to.
+STATE Game::travelToDoor() {
+    World& world = impl_->world_;
+    int row = world.playerRow();
+    int col = world.playerCol();
+    return impl_->travel([&world, row, col](int r, int c) {
+        for (int y = r - 1; y <= r + 1; y++) {
+            for (int x = c - 1; x <= c + 1; x++) {
+                if (y < world.firstRow() || y >= world.height() || x < 0 ||
+                x >= world.width() || !world.tileAt(y, x).door() ||
+                !world.tileAt(y, x).seen() ||
+                (std::abs(y - row) <= 1 && std::abs(x - col) <= 1)) {
+                    continue;
+                }
+                const DoorState* door = world.itemAt(y, x).door();
+                if (door != nullptr && !door->open) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    });
 }
 
 STATE Game::batter() {
-    return impl_.directed("batter down door", &GameImpl::batter);
+    return impl_->directed(this, "batter down door", &GameImpl::batter);
 }
 
 STATE Game::open() {
     bool hasKey = false;
-    player.foreach_carried([&](ITEMPTR& item) {
-        Item* temp = item.get();
-        if (dynamic_cast<Key*>(temp)) {
+    impl_->player_.foreach_carried([&](Item item) {
+        if (item.type() == ITEMTYPE::KEY) {
             hasKey = true;
         }
     });
 
     if (hasKey) {
-        return impl_.directed("open door", &GameImpl::open);
+        return impl_->directed(this, "open door", &GameImpl::open);
     }
-    view.message("You don't have the key.");
+    impl_->view_->message("You don't have the key.");
     return STATE::ERROR;
 }
 
 STATE Game::close() {
-    return impl_.directed("close door", &GameImpl::close);
+    return impl_->directed(this, "close door", &GameImpl::close);
 }
 
 STATE Game::take() {
-    return impl_.take();
+    return impl_->take();
 }
 
 STATE Game::drop() {
-    if (world.itemAt(world.playerRow(), world.playerCol()) != nullptr) {
-        view.message("You can't drop anything here.");
+    if (impl_->world_.itemAt(impl_->world_.playerRow(), impl_->world_.playerCol())) {
+        impl_->view_->message("You can't drop anything here.");
         return STATE::ERROR;
     }
-    view.message("drop what?");
-    int dropped = view.handleNumericalInput(this);
+    impl_->view_->message("drop what?");
+    int dropped = impl_->view_->handleNumericalInput(this);
     if (dropped != 0) {
-        Item* temp = player.drop(dropped);
-        if (temp != nullptr) {
-            world.insertItem(world.playerRow(), world.playerCol(), temp);
+        Item temp = impl_->player_.drop(dropped);
+        if (temp) {
+            impl_->world_.insertItem(impl_->world_.playerRow(), impl_->world_.playerCol(), temp);
+            return impl_->acted(STATE::COMMAND);
         }
     }
     return STATE::COMMAND;
 }
 
 STATE Game::wield() {
-    view.message("wield what?");
-    int dropped = view.handleNumericalInput(this);
+    impl_->view_->message("wield what?");
+    int dropped = impl_->view_->handleNumericalInput(this);
     if (dropped > 2 && dropped < 7) {
-        Item* temp = player.drop(dropped);
-        if (temp != nullptr) {
-            if (dynamic_cast<Armament*>(temp)) {
-                if (player.wield(temp) == false) {
-                    view.message("Your hands are full.");
-                    player.carry(temp);
+        Item temp = impl_->player_.drop(dropped);
+        if (temp) {
+            if (temp.armament()) {
+                if (impl_->player_.wield(temp) == false) {
+                    impl_->view_->message("Your hands are full.");
+                    impl_->player_.carry(temp);
                 }
             } else {
-                view.message("You can't wield that.");
-                player.carry(temp);
+                impl_->view_->message("You can't wield that.");
+                impl_->player_.carry(temp);
             }
         }
     }
@@ -321,14 +472,14 @@ STATE Game::wield() {
 }
 
 STATE Game::unwield() {
-    view.message("unwield what?");
-    int dropped = view.handleNumericalInput(this);
+    impl_->view_->message("unwield what?");
+    int dropped = impl_->view_->handleNumericalInput(this);
     if (dropped > 0 && dropped < 3) {
-        Item* temp = player.drop(dropped);
-        if (temp != nullptr) {
-            if (player.carry(temp) == false) {
-                view.message("You are carrying too much.");
-                player.wield(temp);
+        Item temp = impl_->player_.drop(dropped);
+        if (temp) {
+            if (impl_->player_.carry(temp) == false) {
+                impl_->view_->message("You are carrying too much.");
+                impl_->player_.wield(temp);
             }
         }
     }
@@ -336,203 +487,581 @@ STATE Game::unwield() {
 }
 
 STATE Game::quit() {
-    view.message("Are you sure you want to quit? (y/n)");
-    return view.handleBooleanInput(this) ? STATE::QUIT : STATE::COMMAND;
+    impl_->view_->message("Are you sure you want to quit? (y/n)");
+    return impl_->view_->handleBooleanInput(this) ? STATE::QUIT : STATE::COMMAND;
 }
 
 STATE Game::refresh() {
-    view.refresh();
+    impl_->view_->refresh();
 
     return STATE::COMMAND;
 }
 
 STATE Game::resize() {
-    view.resize(world);
+    impl_->view_->resize(impl_->world_);
     draw();
     return STATE::COMMAND;
 }
 
 STATE Game::shell() {
-    view.shell();
+    impl_->view_->shell();
 
     return STATE::COMMAND;
 }
 
 STATE Game::quaff() {
-    bool quaffed = false;
-    player.foreach_carried([&](ITEMPTR& item) {
-        if (quaffed == false) {
-            Item* temp = item.get();
-            if (dynamic_cast<Potion*>(temp)) {
-                player.setHealth(10 - player.health());
-                delete item.release();
-                quaffed = true;
-            }
+    Item potion;
+    impl_->player_.foreach_carried([&](Item item) {
+        if (!potion && item.type() == ITEMTYPE::POTION) {
+            potion = item;
         }
     });
 
-    if (quaffed) {
-        return STATE::COMMAND;
+    if (impl_->player_.destroy(potion)) {
+        impl_->player_.setHealth(10 - impl_->player_.health());
+        return impl_->acted(STATE::COMMAND);
     }
 
-    view.message("You don't have any potions.");
+    impl_->view_->message("You don't have any potions.");
     return STATE::ERROR;
 }
 
 STATE Game::version() {
     std::stringstream banner;
 
-     banner <<  impl_.name_ << ' ' << impl_.version_;
-     view.message(banner.str());
+     banner <<  impl_->name_ << ' ' << impl_->version_ << " (seed "
+        << impl_->seed_ << ')';
+     impl_->view_->message(banner.str());
 
      return STATE::COMMAND;
 }
 
-Game::GameImpl::GameImpl() : name_{""}, version_{""} {
+Game::GameImpl::GameImpl(std::unique_ptr<View> view) : name_{""},
+version_{""}, turns_{0}, ticks_{0}, height_{DEFAULT_MAP_HEIGHT},
+width_{DEFAULT_MAP_WIDTH}, seed_{std::random_device{}()}, maze_{DEFAULT_MAZE}, endless_{false},
+chunkBudget_{0}, fovRadius_{DEFAULT_FOV_RADIUS}, hunting_{false}, combat_{},
+world_{},
+player_{world_.entities()}, pathing_{world_}, monsters_{}, engaged_{NO_ENTITY},
+view_{std::move(view)} {
+}
+
+// Everything the player does which takes a turn ends here, so that the
+// monsters get theirs.  Being attacked stops the player running.
+STATE Game::GameImpl::acted(STATE state) {
+    Entity engaged = std::exchange(engaged_, NO_ENTITY);
+    if (!hunting_ || state == STATE::DEAD) {
+        return state;
+    }
+
+    int attacks = monsters_.turn(world_, player_, pathing_, combat_, engaged,
+        [this](std::string_view message) { view_->message(message); });
+    if (player_.health() < 1) {
+        view_->message("You are dead.");
+        player_.setKeepFighting(false);
+        return STATE::DEAD;
+    }
+    if (attacks > 0 && state == STATE::MOVING) {
+        player_.setKeepMoving(false);
+        return STATE::COMMAND;
+    }
+    return state;
+}
+
+// Works out what the player can see and lets the frontier know.
+void Game::GameImpl::look() {
+    world_.fov();
+    pathing_.looked(world_.playerRow(), world_.playerCol(),
+        world_.fovRadius());
+}
+
+std::vector<Entity> Game::GameImpl::monstersInView() {
+    std::vector<Entity> monsters;
+    int radius = world_.fovRadius();
+    world_.foreach_item(world_.playerRow() - radius,
+    world_.playerCol() - radius, 2 * radius + 1, 2 * radius + 1,
+    [&](int row, int col, Item item) {
+        if (world_.tileAt(row, col).visible() && item.combat()) {
+            monsters.push_back(item.entity());
+        }
+    });
+    return monsters;
+}
+
+// Takes the steps of a path in turn as if they had been typed, with no
+// drawing in between.  It stops short, saying why in why, for a sprung trap
+// (unless moving over things), a monster or a shut door in the way, for
+// picking something up, for being hurt and for a monster coming into view
+// which isn't one of those known about already.  A trap which hasn't been
+// sprung can't be seen, so it is walked into.  why is left empty if the
+// path was walked to the end.
+STATE Game::GameImpl::walk(const std::vector<Position>& path,
+const std::vector<Entity>& known, std::string& why) {
+    for (auto& step : path) {
+        Item item = world_.itemAt(step.row, step.col);
+        if (item.trap() && item.trap()->sprung && player_.pickup()) {
+            why = "There is a trap in the way.";
+            return STATE::COMMAND;
+        }
+        if (item.combat()) {
+            why = "There is " + std::string(item.article()) + ' ' +
+                std::string(item.name()) + " in the way.";
+            return STATE::COMMAND;
+        }
+        if (item.door() && !item.door()->open) {
+            why = "The door is shut.";
+            return STATE::COMMAND;
+        }
+
+        int health = player_.health();
+        player_.setFacingY(step.row - world_.playerRow());
+        player_.setFacingX(step.col - world_.playerCol());
+        player_.setKeepMoving(false);
+        STATE state = move();
+        turns_++;
+        if (state != STATE::COMMAND) {
+            return state;
+        }
+        look();
+
+        if (player_.health() < health) {
+            why = "You are hurt.";
+            return STATE::COMMAND;
+        }
+        if (item && !item.door() && !item.trap() && player_.pickup()) {
+            why = "You pick up " + std::string(item.article()) + ' ' +
+                std::string(item.name()) + '.';
+            return STATE::COMMAND;
+        }
+        if (world_.playerRow() != step.row || world_.playerCol() != step.col) {
+            return STATE::COMMAND;
+        }
+        for (Entity monster : monstersInView()) {
+            if (std::find(known.begin(), known.end(), monster) == known.end()) {
+                Item seen(&world_.entities(), monster);
+                why = "You see " + std::string(seen.article()) + ' ' +
+                    std::string(seen.name()) + '.';
+                return STATE::COMMAND;
+            }
+        }
+    }
+    return STATE::COMMAND;
+}
+
+// Heads down the frontier field to the nearest place not yet explored, and
+// on from there to the next, until there is nowhere left or something
+// interrupts.  It gives up after MAX_WALK steps, as an endless maze never
+// runs out.
+STATE Game::GameImpl::explore() {
+    look();
+    std::vector<Entity> known = monstersInView();
+    std::vector<Position> path;
+    std::string why;
+    unsigned long start = turns_;
+    player_.setPickup(true);
+    while (turns_ - start < MAX_WALK &&
+    pathing_.route(GOAL::FRONTIER, path) && !path.empty()) {
+        STATE state = walk(path, known, why);
+        if (state != STATE::COMMAND) {
+            return state;
+        }
+        if (!why.empty()) {
+            view_->message(why);
+            return STATE::COMMAND;
+        }
+    }
+    if (turns_ - start >= MAX_WALK) {
+        view_->message("You stop exploring for now.");
+    } else {
+        view_->message("There is nowhere left to explore.");
+    }
+    return STATE::COMMAND;
+}
+
+// Finds the way to the nearest place for which goal is true, over what the
+// player has seen, and walks it.
+STATE Game::GameImpl::travel(std::function<bool(int, int)> goal) {
+    look();
+    std::vector<Position> path;
+    if (!pathing_.travel(goal, path)) {
+        view_->message("You don't know the way there.");
+        return STATE::ERROR;
+    }
+    if (path.empty()) {
+        view_->message("You are already there.");
+        return STATE::ERROR;
+    }
+
+    std::string why;
+    player_.setPickup(true);
+    STATE state = walk(path, monstersInView(), why);
+    if (state == STATE::COMMAND) {
+        view_->message(why.empty() ? "You have arrived." : why);
+    }
+    return state;
+}
+
+// A trap nobody has sprung looks like any other floor.
+static bool hidden(Item item) {
+    return item.trap() && !item.trap()->sprung;
+}
+
+// The items the player can tell are next to row, col.
+std::vector<Entity> Game::GameImpl::itemsAround(int row, int col) {
+    std::vector<Entity> items;
+    world_.foreach_item(row - 1, col - 1, 3, 3, [&](int r, int c, Item item) {
+        if ((r != row || c != col) && !hidden(item)) {
+            items.push_back(item.entity());
+        }
+    });
+    return items;
+}
+
+// Works out where a run the way the player is facing goes before taking
+// any steps.  A run along a passage follows it round corners and stops
+// where it branches or comes to an end; a diagonal one just goes straight.
+// Either stops before anything in the way and as soon as an item, monster
+// or door it wasn't next to before comes up next to the player.  Traps
+// which haven't been sprung aren't seen, so they don't stop it.  stop says
+// where it stopped, or is left empty if it ran into a wall.
+void Game::GameImpl::plan(std::vector<Position>& path, std::string& stop) {
+    static constexpr int SIDES[4][2] = {
+        { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 }
+    };
+    int row = world_.playerRow();
+    int col = world_.playerCol();
+    int dy = player_.facingY();
+    int dx = player_.facingX();
+    bool follow = dy == 0 || dx == 0;
+    std::vector<Entity> nearby = itemsAround(row, col);
+
+    path.clear();
+    while (path.size() < MAX_WALK && canMove(row + dy, col + dx)) {
+        Item item = world_.itemAt(row + dy, col + dx);
+        if (item.combat() || (item.door() && !item.door()->open) ||
+        (item.trap() && !hidden(item) && player_.pickup())) {
+            stop = "before " + std::string(item.article()) + ' ' +
+                std::string(item.name());
+            return;
+        }
+        row += dy;
+        col += dx;
+        path.push_back(Position{row, col});
+        if (item && !item.door() && !item.trap() && player_.pickup()) {
+            stop = "on " + std::string(item.article()) + ' ' +
+                std::string(item.name());
+            return;
+        }
+
+        std::vector<Entity> around = itemsAround(row, col);
+        for (Entity entity : around) {
+            if (std::find(nearby.begin(), nearby.end(), entity) ==
+            nearby.end()) {
+                Item next(&world_.entities(), entity);
+                stop = "next to " + std::string(next.article()) + ' ' +
+                    std::string(next.name());
+                return;
+            }
+        }
+        nearby = std::move(around);
+
+        if (follow) {
+            int exits = 0;
+            int backY = -dy;
+            int backX = -dx;
+            for (auto& side : SIDES) {
+                if ((side[0] != backY || side[1] != backX) &&
+                canMove(row + side[0], col + side[1])) {
+                    exits++;
+                    dy = side[0];
+                    dx = side[1];
+                }
+            }
+            if (exits == 0) {
+                stop = "at a dead end";
+                return;
+            }
+            if (exits > 1) {
+                stop = "where the passage branches";
+                return;
+            }
+        }
+    }
+}
+
+// The whole of a run is worked out and walked in one go and summed up in
+// one message, so the view only draws where it ends up.  A run that can't
+// get anywhere is a single step, which says why not.
+STATE Game::GameImpl::run() {
+    std::vector<Position> path;
+    std::string stop;
+    look();
+    plan(path, stop);
+    if (path.empty()) {
+        Item ahead = world_.itemAt(world_.playerRow() + player_.facingY(),
+            world_.playerCol() + player_.facingX());
+        if (ahead.trap() && !hidden(ahead) && player_.pickup()) {
+            view_->message("There is a trap in the way.");
+            return STATE::ERROR;
+        }
+        return move();
+    }
+
+    unsigned long start = turns_;
+    std::string why;
+    STATE state = walk(path, monstersInView(), why);
+    if (state != STATE::COMMAND) {
+        return state;
+    }
+    unsigned long steps = turns_ - start;
+    std::stringstream output;
+    output << "You run " << steps << (steps == 1 ? " step" : " steps");
+    if (!why.empty()) {
+        output << ". " << why;
+    } else if (!stop.empty()) {
+        output << " and stop " << stop << '.';
+    } else {
+        output << '.';
+    }
+    view_->message(output.str());
+    return STATE::COMMAND;
 }
 
 STATE Game::GameImpl::fight() {
-    int row = world.playerRow() + player.facingY();
-    int col = world.playerCol() + player.facingX();
-    if (Monster* monster = dynamic_cast<Monster*>(world.itemAt(row, col))) {
+    int row = world_.playerRow() + player_.facingY();
+    int col = world_.playerCol() + player_.facingX();
+    Item monster = world_.itemAt(row, col);
+    if (monster.combat()) {
         return fightHere(row, col, monster);
     }
-    view.message("Nothing to fight here.");
+    view_->message("Nothing to fight here.");
     return STATE::ERROR;
 }
 
-STATE Game::GameImpl::fightHere(int row, int col, Monster*& monster) {
+STATE Game::GameImpl::fightHere(int row, int col, Item item) {
     std::stringstream output;
+    engaged_ = item.entity();
+    Combat* monster = item.combat();
+    std::string_view name = item.name();
+    ITEMTYPE type = item.type();
 
     int offenseBonus = 0, defenseBonus = 0;
-    player.foreach_wielded([&](ITEMPTR& item) {
-        Item* temp = item.get();
-        if (temp != nullptr) {
-            offenseBonus += dynamic_cast<Armament*>(temp)->offenseBonus();
-            defenseBonus += dynamic_cast<Armament*>(temp)->defenseBonus();
+    player_.foreach_wielded([&](Item wielded) {
+        if (Armament* armament = wielded.armament()) {
+            offenseBonus += armament->offenseBonus();
+            defenseBonus += armament->defenseBonus();
         }
     });
 
-    if (monster->attack() <= (player.defend() + defenseBonus)) {
-        output << "The " << monster->name() << " misses you. ";
+    if (monster->attack(combat_) <= (player_.defend(combat_) + defenseBonus)) {
+        output << "The " << name << " misses you. ";
     } else {
-        output << "The " << monster->name() << " hits you. ";
-        player.setHealth(-1);
-        if (monster->type() == ITEMTYPE::WIZARD) { // Teleport
-            player.setKeepFighting(false);
-            world.setPlayerRow(0);
-            world.setPlayerCol(world.startCol());
-        } else if (monster->type() == ITEMTYPE::DRAGON) {
-            player.setHealth(-2);
+        output << "The " << name << " hits you. ";
+        player_.setHealth(-1);
+        if (type == ITEMTYPE::WIZARD) { // Teleport
+            player_.setKeepFighting(false);
+            world_.returnToStart();
+        } else if (type == ITEMTYPE::DRAGON) {
+            player_.setHealth(-2);
         }
     }
 
-    if ((player.attack() + offenseBonus) <= monster->defend()) {
-        output << "You miss the " << monster->name() << ". ";
+    if ((player_.attack(combat_) + offenseBonus) <= monster->defend(combat_)) {
+        output << "You miss the " << name << ". ";
     } else {
-        output << "You hit the " << monster->name() << ". ";
+        output << "You hit the " << name << ". ";
         monster->setHealth(-1);
     }
 
     STATE result;
 
     if (monster->health() < 1 ) {
-        world.setPlayerRow(row);
-        world.setPlayerCol(col);
-        output << "You kill the "  << monster->name() << ". ";
-        if (monster->type() == ITEMTYPE::DRAGON) {
+        world_.setPlayerRow(row);
+        world_.setPlayerCol(col);
+        output << "You kill the "  << name << ". ";
+        if (type == ITEMTYPE::DRAGON) {
             output << "You have won!";
             result = STATE::DEAD;
         } else {
             result = STATE::COMMAND;
         }
-        world.removeItem(row, col, true);
-        player.setKeepFighting(false);
-    } else if (player.keepFighting()) {
+        world_.removeItem(row, col, true);
+        player_.setKeepFighting(false);
+    } else if (player_.keepFighting()) {
         result =  STATE::FIGHTING;
     } else {
-        player.setKeepFighting(false);
+        player_.setKeepFighting(false);
         result = STATE::COMMAND;
     }
 
-    if ( player.health() < 1 ) {
-        if (monster->type() == ITEMTYPE::TROLL) {
+    if ( player_.health() < 1 ) {
+        if (type == ITEMTYPE::TROLL) {
             output << "YHBT. YHL. HAND!";
         } else {
             output << "You are dead.";
         }
-        player.setKeepFighting(false);
+        player_.setKeepFighting(false);
         result = STATE::DEAD;
     }
 
-    view.message(output.str());
+    view_->message(output.str());
 
-    return result;
+    return acted(result);
+}
+
+// When the monsters are hunting the others get their turns between rounds,
+// so the fight goes a round at a time.  Otherwise it is settled at once.
+STATE Game::GameImpl::fightToDeath() {
+    int row = world_.playerRow() + player_.facingY();
+    int col = world_.playerCol() + player_.facingX();
+    Item monster = world_.itemAt(row, col);
+    if (!monster.combat()) {
+        view_->message("Nothing to fight here.");
+        return STATE::ERROR;
+    }
+    if (hunting_) {
+        return fightHere(row, col, monster);
+    }
+    return fightOut(row, col, monster);
+}
+
+// Picks how the whole fight goes from the odds of every way it could, and
+// sums it up in one message instead of one per round.
+STATE Game::GameImpl::fightOut(int row, int col, Item item) {
+    Combat* monster = item.combat();
+    std::string_view name = item.name();
+    ITEMTYPE type = item.type();
+
+    int offenseBonus = 0, defenseBonus = 0;
+    player_.foreach_wielded([&](Item wielded) {
+        if (Armament* armament = wielded.armament()) {
+            offenseBonus += armament->offenseBonus();
+            defenseBonus += armament->defenseBonus();
+        }
+    });
+
+    Bout matched = bout(player_, offenseBonus, defenseBonus, *monster, type);
+    Fight fought = ::fight(matched, combat_);
+    turns_ += fought.rounds - 1;
+    player_.setHealth(-fought.taken * matched.damage);
+    monster->setHealth(-fought.dealt);
+    player_.setKeepFighting(false);
+    engaged_ = item.entity();
+
+    std::stringstream output;
+    if (fought.ending == ENDING::STALEMATE) {
+        output << "You can't hurt the " << name << " and it can't hurt you.";
+        view_->message(output.str());
+        return acted(STATE::COMMAND);
+    }
+    output << "You fight the " << name << " for " << fought.rounds
+           << (fought.rounds == 1 ? " round" : " rounds");
+    if (fought.taken == 0) {
+        output << " and it never hits you. ";
+    } else if (fought.taken == 1) {
+        output << " and it hits you once. ";
+    } else {
+        output << " and it hits you " << fought.taken << " times. ";
+    }
+    if (matched.teleports && fought.taken > 0) {
+        world_.returnToStart();
+    }
+
+    STATE result = STATE::COMMAND;
+    if (monster->health() < 1) {
+        world_.setPlayerRow(row);
+        world_.setPlayerCol(col);
+        output << "You kill the " << name << ". ";
+        if (type == ITEMTYPE::DRAGON) {
+            output << "You have won!";
+            result = STATE::DEAD;
+        }
+        world_.removeItem(row, col, true);
+    }
+    if (player_.health() < 1) {
+        if (type == ITEMTYPE::TROLL) {
+            output << "YHBT. YHL. HAND!";
+        } else {
+            output << "You are dead.";
+        }
+        result = STATE::DEAD;
+    }
+
+    view_->message(output.str());
+
+    return acted(result);
 }
 
 STATE Game::GameImpl::batter() {
-    int row = world.playerRow() + player.facingY();
-    int col = world.playerCol() + player.facingX();
-
-    if (dynamic_cast<Door*>(world.itemAt(row, col))) {
-        view.message("You smash the door down.");
-        world.removeItem(row, col, true);
-        player.setHealth(-2);
-        if (player.health() < 1) {
-            view.message("You are dead.");
+    int row = world_.playerRow() + player_.facingY();
+    int col = world_.playerCol() + player_.facingX();
+
+    if (world_.itemAt(row, col).door()) {
+        view_->message("You smash the door down.");
+        world_.removeItem(row, col, true);
+        world_.autotile(row - 1, col - 1, 3, 3);
+        pathing_.changed(row, col);
+        player_.setHealth(-2);
+        if (player_.health() < 1) {
+            view_->message("You are dead.");
             return STATE::DEAD;
         }
-        return STATE::COMMAND;
+        return acted(STATE::COMMAND);
     }
-    view.message("Nothing to batter down here.");
+    view_->message("Nothing to batter down here.");
     return STATE::ERROR;
 
 }
 
 STATE Game::GameImpl::close() {
-    int row = world.playerRow() + player.facingY();
-    int col = world.playerCol() + player.facingX();
+    int row = world_.playerRow() + player_.facingY();
+    int col = world_.playerCol() + player_.facingX();
 
-    if (Door* door = dynamic_cast<Door*>(world.itemAt(row, col))) {
-        if (door->open() == false) {
-            view.message("The door is already closed.");
+    if (DoorState* door = world_.itemAt(row, col).door()) {
+        if (door->open == false) {
+            view_->message("The door is already closed.");
             return STATE::ERROR;
         } else {
-            door->setOpen(false);
+            door->open = false;
+            world_.invalidateFov();
+            world_.modified(row, col);
+            pathing_.changed(row, col);
         }
-        return STATE::COMMAND;
+        return acted(STATE::COMMAND);
     }
-    view.message("Nothing to close here.");
+    view_->message("Nothing to close here.");
     return STATE::ERROR;
 }
 
 STATE Game::GameImpl::open() {
-    int row = world.playerRow() + player.facingY();
-    int col = world.playerCol() + player.facingX();
+    int row = world_.playerRow() + player_.facingY();
+    int col = world_.playerCol() + player_.facingX();
 
-    if (Door* door = dynamic_cast<Door*>(world.itemAt(row, col))) {
-        if (door->open() == true) {
-            view.message("The door is already open.");
+    if (DoorState* door = world_.itemAt(row, col).door()) {
+        if (door->open == true) {
+            view_->message("The door is already open.");
             return STATE::ERROR;
         } else {
-            door->setOpen(true);
+            door->open = true;
+            world_.invalidateFov();
+            world_.modified(row, col);
+            pathing_.changed(row, col);
         }
-        return STATE::COMMAND;
+        return acted(STATE::COMMAND);
     }
-    view.message("Nothing to open here.");
+    view_->message("Nothing to open here.");
     return STATE::ERROR;
 }
 
 bool Game::GameImpl::canMove(int row, int col) {
-    if (row < 0
-        || row >= world.height()
+    if (row < world_.firstRow()
+        || row >= world_.height()
         || col < 0
-        || col >= world.width()) {
+        || col >= world_.width()) {
         return false;
     }
 
-    Tile* t = world.tileAt( row, col );
-    if(t->passable() == false) {
+    Tile t = world_.tileAt( row, col );
+    if(t.passable() == false) {
         return false;
     }
 
@@ -540,139 +1069,143 @@ bool Game::GameImpl::canMove(int row, int col) {
 }
 
 STATE Game::GameImpl::move() {
-    int row = world.playerRow() + player.facingY();
-    int col = world.playerCol() + player.facingX();
+    int row = world_.playerRow() + player_.facingY();
+    int col = world_.playerCol() + player_.facingX();
     if(canMove(row, col) == false) {
-        if (player.keepMoving()){
-            player.setKeepMoving(false);
+        if (player_.keepMoving()){
+            player_.setKeepMoving(false);
             return STATE::COMMAND;
         } else {
-            view.message("You can't go there!");
+            view_->message("You can't go there!");
             return STATE::ERROR;
         }
     }
 
-    if (Item *item = world.itemAt(row, col)) {
-
-        if (Door* d = dynamic_cast<Door*>(item)) {
-            if (d->open() == false) {
-                view.message("The door is shut.");
+    if (Item item = world_.itemAt(row, col)) {
+        switch (item.type()) {
+        case ITEMTYPE::DOOR:
+            if (item.door()->open == false) {
+                view_->message("The door is shut.");
                 return STATE::ERROR;
             }
+            break;
 
-        } else if (Trap* trap = dynamic_cast<Trap*>(item)) {
-            if (player.pickup()) {
-                view.message("You have stepped in a trap.");
-                player.setHealth(-2);
-                if (player.health() < 1) {
-                    view.message("You are dead.");
+        case ITEMTYPE::TRAP:
+            if (player_.pickup()) {
+                view_->message("You have stepped in a trap.");
+                player_.setHealth(-2);
+                if (player_.health() < 1) {
+                    view_->message("You are dead.");
                     return STATE::DEAD;
                 }
-                trap->setSprung(true);
+                item.trap()->sprung = true;
+                world_.modified(row, col);
+                pathing_.changed(row, col);
             }
+            break;
 
-        } else if (Monster* monster = dynamic_cast<Monster*>(item)) {
-                 return fightHere(row, col, monster);
-
-        } else {
-            if (player.pickup()) {
+        default:
+            if (item.combat()) {
+                return fightHere(row, col, item);
+            }
+            if (player_.pickup()) {
                 return takeHere(row, col, item);
             }
+            break;
         }
     }
-    world.setPlayerRow(row);
-    world.setPlayerCol(col);
+    world_.setPlayerRow(row);
+    world_.setPlayerCol(col);
 
-    return player.keepMoving() ? STATE::MOVING : STATE::COMMAND;
+    return acted(player_.keepMoving() ? STATE::MOVING : STATE::COMMAND);
 }
 
 STATE Game::GameImpl::take() {
-    int row = world.playerRow();
-    int col = world.playerCol();
+    int row = world_.playerRow();
+    int col = world_.playerCol();
 
-    Item* item = world.itemAt(row, col);
+    Item item = world_.itemAt(row, col);
 
-    if (item != nullptr) {
+    if (item) {
         return takeHere(row, col, item);
     }
 
-    view.message("Nothing to take here.");
+    view_->message("Nothing to take here.");
     return STATE::ERROR;
 }
 
-STATE Game::GameImpl::takeHere(int row, int col, Item*& item) {
-    if (dynamic_cast<Monster*>(item) || dynamic_cast<Door*>(item) || dynamic_cast<Trap*>(item)) {
-        view.message("You can't take that!");
+STATE Game::GameImpl::takeHere(int row, int col, Item item) {
+    if ((item.archetype().flags & TAKEABLE) == 0) {
+        view_->message("You can't take that!");
         return STATE::ERROR;
     } else {
-        if (player.carry(item) == false) {
-            view.message("You are carrying too much.");
+        if (player_.carry(item) == false) {
+            view_->message("You are carrying too much.");
             return STATE::ERROR;
         }
     }
 
-    world.removeItem(row, col);
-    world.setPlayerRow(row);
-    world.setPlayerCol(col);
-    return STATE::COMMAND;
+    world_.removeItem(row, col);
+    world_.setPlayerRow(row);
+    world_.setPlayerCol(col);
+    return acted(STATE::COMMAND);
 }
 
-STATE Game::GameImpl::directed(std::string command,
+STATE Game::GameImpl::directed(Game* game, std::string command,
 std::function<STATE(GameImpl&)> func) {
 
     std::stringstream prompt;
     prompt << command << " in which direction?";
-    view.message(prompt.str());
-    Game game;
+    view_->message(prompt.str());
 
-    switch(view.handleDirectionInput(&game)) {
+    switch(view_->handleDirectionInput(game)) {
         case DIRECTION::NORTH:
-            player.setFacingY(-1);
-            player.setFacingX(0);
-            return func(impl_);
+            player_.setFacingY(-1);
+            player_.setFacingX(0);
+            return func(*this);
             break;
         case DIRECTION::EAST:
-            player.setFacingY(0);
-            player.setFacingX(1);
-            return func(impl_);
+            player_.setFacingY(0);
+            player_.setFacingX(1);
+            return func(*this);
             break;
         case DIRECTION::WEST:
-            player.setFacingY(0);
-            player.setFacingX(-1);
-            return func(impl_);
+            player_.setFacingY(0);
+            player_.setFacingX(-1);
+            return func(*this);
             break;
         case DIRECTION::SOUTH:
-            player.setFacingY(1);
-            player.setFacingX(0);
-            return func(impl_);
+            player_.setFacingY(1);
+            player_.setFacingX(0);
+            return func(*this);
             break;
         case DIRECTION::NORTHWEST:
-            player.setFacingY(-1);
-            player.setFacingX(-1);
-            return func(impl_);
+            player_.setFacingY(-1);
+            player_.setFacingX(-1);
+            return func(*this);
             break;
         case DIRECTION::NORTHEAST:
-            player.setFacingY(-1);
-            player.setFacingX(1);
-            return func(impl_);
+            player_.setFacingY(-1);
+            player_.setFacingX(1);
+            return func(*this);
             break;
         case DIRECTION::SOUTHWEST:
-            player.setFacingY(1);
-            player.setFacingX(-1);
-            return func(impl_);
+            player_.setFacingY(1);
+            player_.setFacingX(-1);
+            return func(*this);
             break;
         case DIRECTION::SOUTHEAST:
-            player.setFacingY(1);
-            player.setFacingX(1);
-            return func(impl_);
+            player_.setFacingY(1);
+            player_.setFacingX(1);
+            return func(*this);
             break;
         case DIRECTION::CANCELLED:
-            view.message("");
+            view_->message("");
             return STATE::COMMAND;
             break;
         case DIRECTION::NO_DIRECTION:
         default:
-            view.message("Huh?");
+            view_->message("Huh?");
             return STATE::ERROR;
             break;
     }
@@ -0,0 +1,218 @@
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "game.h"
+#include "nullview.h"
+#include "version.h"
+#include "world.h"
+
+// Plays games without a terminal, taking keystrokes from a script file (or
+// standard input if the file is - or missing) and reports how fast it went.
+// Every game is an independent session so they can be spread over threads.
+
+struct Result {
+    unsigned long games;
+    unsigned long turns;
+    double        seconds;
+};
+
+static void usage(const char* program) {
+    std::cerr << "usage: " << program << " [-n games] [-j threads] [-s HEIGHTxWIDTH] [-e] [-m MB] [-H] [-r seed] [-S] [script]\n"
+              << "  -n games    number of games to play (default 1)\n"
+              << "  -j threads  number of threads to play them on (default 1)\n"
+              << "  -s size     dimensions of the maze (default "
+              << DEFAULT_MAP_HEIGHT << 'x' << DEFAULT_MAP_WIDTH << ")\n"
+              << "  -e          play an endless maze (only the width of -s is used)\n"
+              << "  -m MB       generate the maze in chunks and keep about MB megabytes\n"
+              << "  -H          monsters near the player wake up and come after them\n"
+              << "  -r seed     seed of the first game; game n gets seed + n (default random)\n"
+              << "  -S          repeat with 1, 2, 4 ... threads and report scaling"
+              << std::endl;
+    exit(EXIT_FAILURE);
+}
+
+static bool readScript(const std::string& filename, std::string& script) {
+    if (filename == "-") {
+        script.assign(std::istreambuf_iterator<char>(std::cin),
+            std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    script.assign(std::istreambuf_iterator<char>(in),
+        std::istreambuf_iterator<char>());
+    return true;
+}
+
+static bool parseSize(const char* arg, int& height, int& width) {
+    char extra;
+    if (std::sscanf(arg, "%dx%d%c", &height, &width, &extra) != 2) {
+        return false;
+    }
+    return height >= MIN_MAP_SIZE && height <= MAX_MAP_SIZE &&
+        width >= MIN_MAP_SIZE && width <= MAX_MAP_SIZE;
+}
+
+static bool parseSeed(const char* arg, std::uint64_t& seed) {
+    char extra;
+    return std::sscanf(arg, "%" SCNu64 "%c", &seed, &extra) == 1;
+}
+
+static Result play(const std::string& script, unsigned long games,
+unsigned int threads, int height, int width, bool endless,
+std::size_t budget, bool hunting, const std::uint64_t* seed) {
+    std::vector<std::thread> workers;
+    std::vector<unsigned long> turns(threads, 0);
+
+    auto start = std::chrono::steady_clock::now();
+
+    unsigned long first = 0;
+    for (unsigned int t = 0; t < threads; t++) {
+        // Share the games out as evenly as possible.
+        unsigned long share = games / threads + (t < games % threads ? 1 : 0);
+
+        workers.emplace_back([&script, &turns, share, first, t, height, width,
+        endless, budget, hunting, seed]() {
+            for (unsigned long i = 0; i < share; i++) {
+                Game game(std::unique_ptr<View>(new NullView(script)));
+                game.setWorldSize(height, width);
+                game.setEndless(endless);
+                game.setChunkBudget(budget);
+                game.setHunting(hunting);
+                if (seed != nullptr) {
+                    game.setSeed(*seed + first + i);
+                }
+                game.run(NAME, VERSION);
+                turns[t] += game.turns();
+            }
+        });
+        first += share;
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    Result result { games, 0, elapsed.count() };
+    for (auto t : turns) {
+        result.turns += t;
+    }
+    return result;
+}
+
+static double perSecond(unsigned long count, double seconds) {
+    return seconds > 0 ? count / seconds : 0;
+}
+
+int main(int argc, char **argv) {
+    unsigned long games = 1;
+    unsigned int threads = 1;
+    int height = DEFAULT_MAP_HEIGHT;
+    int width = DEFAULT_MAP_WIDTH;
+    std::uint64_t seed = 0;
+    bool seeded = false;
+    bool endless = false;
+    std::size_t budget = 0;
+    bool hunting = false;
+    bool scaling = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:j:s:em:Hr:S")) != -1) {
+        switch (opt) {
+        case 'n':
+            games = std::strtoul(optarg, nullptr, 10);
+            break;
+        case 'j':
+            threads = std::strtoul(optarg, nullptr, 10);
+            break;
+        case 's':
+            if (!parseSize(optarg, height, width)) {
+                usage(argv[0]);
+            }
+            break;
+        case 'e':
+            endless = true;
+            break;
+        case 'm':
+            budget = static_cast<std::size_t>(std::strtoul(optarg, nullptr, 10)) << 20;
+            break;
+        case 'H':
+            hunting = true;
+            break;
+        case 'r':
+            if (!parseSeed(optarg, seed)) {
+                usage(argv[0]);
+            }
+            seeded = true;
+            break;
+        case 'S':
+            scaling = true;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if (games < 1 || threads < 1 || argc - optind > 1) {
+        usage(argv[0]);
+    }
+
+    std::string filename = (optind < argc) ? argv[optind] : "-";
+    std::string script;
+    if (!readScript(filename, script)) {
+        std::cerr << argv[0] << ": can't read " << filename << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!scaling) {
+        Result result = play(script, games, threads, height, width, endless,
+            budget, hunting, seeded ? &seed : nullptr);
+        std::cout << "games: " << result.games << '\n'
+                  << "turns: " << result.turns << '\n'
+                  << "seconds: " << result.seconds << '\n'
+                  << "games/second: " << perSecond(result.games, result.seconds) << '\n'
+                  << "turns/second: " << perSecond(result.turns, result.seconds)
+                  << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    // Each thread count plays the same number of games, so with perfect
+    // scaling the speedup equals the thread count.
+    std::cout << "cores available: " << std::thread::hardware_concurrency()
+              << '\n' << "threads\tseconds\tgames/second\tspeedup\tefficiency"
+              << std::endl;
+
+    double baseline = 0;
+    for (unsigned int t = 1; t <= threads; t = (t == threads) ? t + 1 :
+    std::min(t * 2, threads)) {
+        Result result = play(script, games, t, height, width, endless,
+            budget, hunting, seeded ? &seed : nullptr);
+        double rate = perSecond(result.games, result.seconds);
+        if (t == 1) {
+            baseline = rate;
+        }
+        double speedup = baseline > 0 ? rate / baseline : 0;
+        std::cout << t << '\t' << result.seconds << '\t' << rate << '\t'
+                  << speedup << '\t' << speedup / t << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -1,55 +1,90 @@
 #include "item.h"
 
-struct Item::ItemImpl {
-    ItemImpl();
-    ItemImpl(std::string article, std::string name, ITEMTYPE type);
-    ~ItemImpl()=default;
-
-    std::string article_;
-    std::string name_;
-    ITEMTYPE    type_;
+// Shields have always added to the player's attack rather than defense;
+// that is kept so that a seed plays the same as it always has.
+static constexpr Archetype ARCHETYPES[] = {
+    { "",    "nothing",         ITEMTYPE::NOTHING,     ' ', 0, 0, 0,   0, 0 },
+    { "a",   "door",            ITEMTYPE::DOOR,        '+', 0, 0, 0,   0, 0 },
+    { "a",   "trap",            ITEMTYPE::TRAP,        '^', 0, 0, 0,   0, 0 },
+    { "a",   "vampire bat",     ITEMTYPE::BAT,         'B', 1, 0, 2, 200, MONSTER },
+    { "a",   "giant rat",       ITEMTYPE::RAT,         'R', 1, 1, 1, 120, MONSTER },
+    { "a",   "zombie",          ITEMTYPE::ZOMBIE,      'Z', 1, 1, 1,  50, MONSTER },
+    { "a",   "kobold",          ITEMTYPE::KOBOLD,      'K', 1, 1, 2, 100, MONSTER },
+    { "a",   "hobgoblin",       ITEMTYPE::HOBGOBLIN,   'H', 1, 1, 2, 100, MONSTER },
+    { "an",  "orc",             ITEMTYPE::ORC,         'O', 1, 2, 2, 100, MONSTER },
+    { "a",   "giant spider",    ITEMTYPE::SPIDER,      'S', 1, 3, 2, 150, MONSTER },
+    { "a",   "gelatinous cube", ITEMTYPE::CUBE,        'C', 1, 1, 5,  50, MONSTER },
+    { "a",   "lizard man",      ITEMTYPE::LIZARDMAN,   'L', 1, 2, 4, 100, MONSTER },
+    { "a",   "naga",            ITEMTYPE::NAGA,        'N', 1, 3, 3, 100, MONSTER },
+    { "a",   "troll",           ITEMTYPE::TROLL,       'T', 1, 4, 2, 120, MONSTER },
+    { "a",   "minotaur",        ITEMTYPE::MINOTAUR,    'M', 1, 5, 3, 130, MONSTER },
+    { "a",   "wizard",          ITEMTYPE::WIZARD,      'W', 1, 5, 5, 100, MONSTER },
+    { "a",   "floating eye",    ITEMTYPE::FLOATINGEYE, 'F', 1, 5, 5,   0, MONSTER },
+    { "the", "dragon",          ITEMTYPE::DRAGON,      'D', 1, 6, 6,   0, MONSTER },
+    { "a",   "healing potion",  ITEMTYPE::POTION,      '!', 0, 0, 0,   0, TAKEABLE },
+    { "a",   "key",             ITEMTYPE::KEY,         'k', 0, 0, 0,   0, TAKEABLE },
+    { "a",   "buckler",         ITEMTYPE::SHIELD,      ']', 0, 1, 0,   0, TAKEABLE | WIELDABLE },
+    { "a",   "shield",          ITEMTYPE::SHIELD,      ']', 0, 2, 0,   0, TAKEABLE | WIELDABLE },
+    { "a",   "sword",           ITEMTYPE::WEAPON,      ')', 0, 1, 0,   0, TAKEABLE | WIELDABLE },
+    { "a",   "battleaxe",       ITEMTYPE::WEAPON,      ')', 0, 2, 0,   0, TAKEABLE | WIELDABLE },
 };
 
-Item::Item() : impl_ { new Item::ItemImpl() } {
+static_assert(sizeof(ARCHETYPES) / sizeof(ARCHETYPES[0]) ==
+    static_cast<std::size_t>(ARCHETYPE::COUNT), "an archetype is missing");
+
+const Archetype& archetype(ARCHETYPE id) {
+    return ARCHETYPES[static_cast<std::size_t>(id)];
+}
+
+Item::Item() : entities_{nullptr}, entity_{NO_ENTITY} {
 }
 
-Item::~Item() {
+Item::Item(Entities* entities, Entity entity) : entities_{entities},
+entity_{entity} {
+}
 
+Item::operator bool() const {
+    return entities_ != nullptr && entities_->alive(entity_);
 }
 
-Item::Item(std::string article, std::string name, ITEMTYPE type) :
-    impl_ { new Item::ItemImpl(article, name, type) } {
+Entity Item::entity() const {
+    return entity_;
 }
 
-std::string Item::article() const {
-    return impl_->article_;
+const Archetype& Item::archetype() const {
+    return ::archetype(archetypeId());
 }
 
-void Item::setArticle(std::string article) {
-    impl_->article_ = article;
+ARCHETYPE Item::archetypeId() const {
+    return entities_ != nullptr ? entities_->archetype(entity_) :
+        ARCHETYPE::NOTHING;
 }
 
-std::string Item::name() const {
-    return impl_->name_;
+std::string_view Item::article() const {
+    return archetype().article;
 }
 
-void Item::setName(std::string name) {
-    impl_->name_ = name;
+std::string_view Item::name() const {
+    return archetype().name;
 }
 
 ITEMTYPE Item::type() const {
-    return impl_->type_;
+    return archetype().type;
+}
+
+Armament* Item::armament() const {
+    return entities_ != nullptr ? entities_->armaments().find(entity_) :
+        nullptr;
 }
 
-void Item::setType(ITEMTYPE type) {
-    impl_->type_ = type;
+Combat* Item::combat() const {
+    return entities_ != nullptr ? entities_->combat().find(entity_) : nullptr;
 }
 
-Item::ItemImpl::ItemImpl() : ItemImpl("", "", ITEMTYPE::NOTHING) {
+DoorState* Item::door() const {
+    return entities_ != nullptr ? entities_->doors().find(entity_) : nullptr;
 }
 
-Item::ItemImpl::ItemImpl(std::string article, std::string name, ITEMTYPE type) :
-article_{article},
-name_{name},
-type_{type} {
+TrapState* Item::trap() const {
+    return entities_ != nullptr ? entities_->traps().find(entity_) : nullptr;
 }
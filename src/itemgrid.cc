@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <utility>
+#include "itemgrid.h"
+
+// Buckets are BUCKETSIZE x BUCKETSIZE tiles.  Each row of a bucket is a
+// BUCKETSIZE bit field of its occupancy mask.
+static constexpr int BUCKETSIZE = 16;
+static constexpr int ROWSPERWORD = 64 / BUCKETSIZE;
+
+// The position of a tile's bit within its bucket's mask.
+static int slot(int row, int col) {
+    return (row % BUCKETSIZE) * BUCKETSIZE + col % BUCKETSIZE;
+}
+
+// The number of occupied slots before slot s; i.e. where the item in slot s
+// is (or would be) kept in the bucket's items_.
+static std::size_t rank(const std::array<std::uint64_t, 4>& occupied, int s) {
+    std::size_t count = 0;
+    for (int i = 0; i < s / 64; i++) {
+        count += __builtin_popcountll(occupied[i]);
+    }
+    std::uint64_t below = (std::uint64_t{1} << (s % 64)) - 1;
+    return count + __builtin_popcountll(occupied[s / 64] & below);
+}
+
+static bool test(const std::array<std::uint64_t, 4>& occupied, int s) {
+    return (occupied[s / 64] >> (s % 64)) & 1;
+}
+
+ItemGrid::ItemGrid() : height_{0}, width_{0}, bucketCols_{0}, size_{0},
+buckets_{} {
+}
+
+void ItemGrid::assign(int height, int width) {
+    height_ = height;
+    width_ = width;
+    bucketCols_ = (width + BUCKETSIZE - 1) / BUCKETSIZE;
+    int bucketRows = (height + BUCKETSIZE - 1) / BUCKETSIZE;
+    size_ = 0;
+    buckets_.clear();
+    buckets_.resize(static_cast<std::size_t>(bucketRows) * bucketCols_);
+}
+
+Entity ItemGrid::at(int row, int col) const {
+    if (row < 0 || row >= height_ || col < 0 || col >= width_) {
+        return NO_ENTITY;
+    }
+
+    const Bucket& b = bucket(row, col);
+    int s = slot(row, col);
+    if (!test(b.occupied_, s)) {
+        return NO_ENTITY;
+    }
+    return b.items_[rank(b.occupied_, s)];
+}
+
+// Returns whatever was there before, which is up to the caller to destroy.
+Entity ItemGrid::insert(int row, int col, Entity entity) {
+    Bucket& b = bucket(row, col);
+    int s = slot(row, col);
+    std::size_t i = rank(b.occupied_, s);
+
+    if (test(b.occupied_, s)) {
+        return std::exchange(b.items_[i], entity);
+    }
+
+    b.occupied_[s / 64] |= std::uint64_t{1} << (s % 64);
+    b.items_.insert(b.items_.begin() + i, entity);
+    size_++;
+    return NO_ENTITY;
+}
+
+Entity ItemGrid::remove(int row, int col) {
+    if (row < 0 || row >= height_ || col < 0 || col >= width_) {
+        return NO_ENTITY;
+    }
+
+    Bucket& b = bucket(row, col);
+    int s = slot(row, col);
+    if (!test(b.occupied_, s)) {
+        return NO_ENTITY;
+    }
+
+    std::size_t i = rank(b.occupied_, s);
+    Entity item = b.items_[i];
+    b.items_.erase(b.items_.begin() + i);
+    b.occupied_[s / 64] &= ~(std::uint64_t{1} << (s % 64));
+    size_--;
+
+    return item;
+}
+
+std::size_t ItemGrid::size() const {
+    return size_;
+}
+
+void ItemGrid::foreach(int top, int left, int height, int width,
+std::function<void(int, int, Entity)> callback) const {
+    int bottom = std::min(top + height, height_);
+    int right = std::min(left + width, width_);
+    top = std::max(top, 0);
+    left = std::max(left, 0);
+
+    // Visit row by row so items come out in the same order as a scan of the
+    // map would find them.
+    for (int row = top; row < bottom; row++) {
+        int r = row % BUCKETSIZE;
+        int word = r / ROWSPERWORD;
+        int shift = (r % ROWSPERWORD) * BUCKETSIZE;
+
+        for (int col = left; col < right; ) {
+            int bucketLeft = col - col % BUCKETSIZE;
+            int bucketRight = std::min(bucketLeft + BUCKETSIZE, right);
+            const Bucket& b = bucket(row, col);
+
+            std::uint64_t bits = (b.occupied_[word] >> shift) &
+                ((std::uint64_t{1} << BUCKETSIZE) - 1);
+            bits &= ~((std::uint64_t{1} << (col - bucketLeft)) - 1);
+            bits &= (std::uint64_t{1} << (bucketRight - bucketLeft)) - 1;
+
+            while (bits) {
+                int c = __builtin_ctzll(bits);
+                bits &= bits - 1;
+                int s = r * BUCKETSIZE + c;
+                callback(row, bucketLeft + c, b.items_[rank(b.occupied_, s)]);
+            }
+
+            col = bucketRight;
+        }
+    }
+}
+
+ItemGrid::Bucket& ItemGrid::bucket(int row, int col) {
+    return buckets_[static_cast<std::size_t>(row / BUCKETSIZE) * bucketCols_ +
+        col / BUCKETSIZE];
+}
+
+const ItemGrid::Bucket& ItemGrid::bucket(int row, int col) const {
+    return buckets_[static_cast<std::size_t>(row / BUCKETSIZE) * bucketCols_ +
+        col / BUCKETSIZE];
+}
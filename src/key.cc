@@ -1,9 +0,0 @@
-#include "key.h"
-
-Key::Key() : Item("a", "key", ITEMTYPE::KEY) {
-}
-
-Key::~Key() {
-
-}
-
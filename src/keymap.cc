@@ -0,0 +1,99 @@
+#include <map>
+
+#include "game.h"
+#include "keymap.h"
+
+using CommandMap = std::map<int, std::function<STATE(Game*)>>;
+using DirectionMap = std::map<int, DIRECTION>;
+
+struct Keymap::KeymapImpl {
+    KeymapImpl();
+    ~KeymapImpl()=default;
+
+    CommandMap              commandkeys_;
+    DirectionMap            directionkeys_;
+};
+
+Keymap::Keymap() : impl_ { new Keymap::KeymapImpl() } {
+}
+
+Keymap::~Keymap() {
+
+}
+
+void Keymap::bindCommand(int key, std::function<STATE(Game*)> command) {
+    impl_->commandkeys_[key] = command;
+}
+
+void Keymap::bindDirection(int key, DIRECTION direction) {
+    impl_->directionkeys_[key] = direction;
+}
+
+STATE Keymap::command(int key, Game* game) const {
+    auto it = impl_->commandkeys_.find(key);
+    if (it != impl_->commandkeys_.end()) {
+        return (it->second)(game);
+    }
+
+    return game->badInput();
+}
+
+DIRECTION Keymap::direction(int key) const {
+    auto it = impl_->directionkeys_.find(key);
+    if (it != impl_->directionkeys_.end()) {
+        return it->second;
+    }
+    return DIRECTION::NO_DIRECTION;
+}
+
+Keymap::KeymapImpl::KeymapImpl() :
+commandkeys_{
+    { 0x12, /* CTRL-R */    &Game::refresh },
+    { 'h',                  &Game::move_left },
+    { 'j',                  &Game::move_down },
+    { 'k',                  &Game::move_up },
+    { 'l',                  &Game::move_right },
+    { 'y',                  &Game::move_upleft },
+    { 'u',                  &Game::move_upright },
+    { 'b',                  &Game::move_downleft },
+    { 'n',                  &Game::move_downright },
+    { 'H',                  &Game::run_left },
+    { 'J',                  &Game::run_down },
+    { 'K',                  &Game::run_up },
+    { 'L',                  &Game::run_right },
+    { 'Y',                  &Game::run_upleft },
+    { 'U',                  &Game::run_upright },
+    { 'B',                  &Game::run_downleft },
+    { 'N',                  &Game::run_downright },
+    { 'm',                  &Game::moveOver },
+    { 'M',                  &Game::runOver },
+    { 'x',                  &Game::explore },
+    { '<',                  &Game::travelToStart },
+    { '>',                  &Game::travelToExit },
+    { '+',                  &Game::travelToDoor },
+    { 'c',                  &Game::close },
+    { 'd',                  &Game::drop },
+    { 'f',                  &Game::fight },
+    { 'F',                  &Game::fightToDeath },
+    { 'o',                  &Game::open },
+    { 'O',                  &Game::batter },
+    { 'q',                  &Game::quaff },
+    { 'Q',                  &Game::quit },
+    { 'U',                  &Game::unwield },
+    { 'v',                  &Game::version },
+    { 'w',                  &Game::wield },
+    { ',',                  &Game::take },
+    { '!',                  &Game::shell },
+},
+directionkeys_{
+    { 'h',              DIRECTION::WEST },
+    { 'j',              DIRECTION::SOUTH },
+    { 'k',              DIRECTION::NORTH },
+    { 'l',              DIRECTION::EAST },
+    { 'y',              DIRECTION::NORTHWEST },
+    { 'u',              DIRECTION::NORTHEAST },
+    { 'b',              DIRECTION::SOUTHWEST },
+    { 'n',              DIRECTION::SOUTHEAST },
+    { 0x1b,/* ESCAPE */ DIRECTION::CANCELLED },
+} {
+}
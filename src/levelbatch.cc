@@ -0,0 +1,155 @@
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "levelbatch.h"
+#include "random.h"
+#include "varint.h"
+#include "world.h"
+
+// How many finished levels each thread may get ahead of the writer.
+static constexpr unsigned long LEVELS_AHEAD = 4;
+
+using PhaseTimes = std::array<double, static_cast<std::size_t>(PHASE::COUNT)>;
+
+struct LevelBatch::LevelBatchImpl {
+    LevelBatchImpl(int height, int width, MAZE maze, std::uint64_t firstSeed);
+    ~LevelBatchImpl()=default;
+
+    void work(unsigned long count, unsigned long window);
+
+    int                      height_;
+    int                      width_;
+    MAZE                     maze_;
+    std::uint64_t            firstSeed_;
+    double                   seconds_;
+    PhaseTimes               phaseSeconds_;
+
+    // Shared between the workers and the writer.
+    std::mutex               mutex_;
+    std::condition_variable  changed_;
+    unsigned long            next_;
+    unsigned long            written_;
+    std::vector<std::string> slots_;
+    std::vector<bool>        ready_;
+};
+
+LevelBatch::LevelBatch(int height, int width, MAZE maze,
+std::uint64_t firstSeed) :
+    impl_ { new LevelBatch::LevelBatchImpl(height, width, maze, firstSeed) } {
+}
+
+LevelBatch::~LevelBatch() {
+
+}
+
+// The file starts with a magic number, a format version and the number of
+// levels, followed by the game seed of each level and the level as written
+// by World::write().
+void LevelBatch::run(unsigned long count, unsigned long threads,
+std::ostream& out) {
+    auto start = std::chrono::steady_clock::now();
+
+    unsigned long window = LEVELS_AHEAD * threads;
+    impl_->next_ = 0;
+    impl_->written_ = 0;
+    impl_->slots_.assign(window, std::string());
+    impl_->ready_.assign(window, false);
+    impl_->phaseSeconds_.fill(0);
+
+    out.write("TGWPWTDN", 8);
+    out.put(1);
+    writeVarint(out, count);
+
+    std::vector<std::thread> workers;
+    for (unsigned long t = 0; t < threads; t++) {
+        workers.emplace_back(&LevelBatchImpl::work, impl_.get(), count, window);
+    }
+
+    for (unsigned long i = 0; i < count; i++) {
+        std::string level;
+        {
+            std::unique_lock<std::mutex> lock(impl_->mutex_);
+            impl_->changed_.wait(lock, [&]() {
+                return impl_->ready_[i % window];
+            });
+            level.swap(impl_->slots_[i % window]);
+            impl_->ready_[i % window] = false;
+            impl_->written_++;
+        }
+        impl_->changed_.notify_all();
+        out.write(level.data(), level.size());
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    impl_->seconds_ = elapsed.count();
+}
+
+double LevelBatch::seconds() const {
+    return impl_->seconds_;
+}
+
+// Summed over all the levels and threads.
+double LevelBatch::phaseSeconds(PHASE phase) const {
+    return impl_->phaseSeconds_[static_cast<std::size_t>(phase)];
+}
+
+// Private methods
+
+LevelBatch::LevelBatchImpl::LevelBatchImpl(int height, int width, MAZE maze,
+std::uint64_t firstSeed) : height_{height}, width_{width}, maze_{maze},
+firstSeed_{firstSeed}, seconds_{0}, phaseSeconds_{}, mutex_{}, changed_{},
+next_{0}, written_{0}, slots_{}, ready_{} {
+}
+
+void LevelBatch::LevelBatchImpl::work(unsigned long count,
+unsigned long window) {
+    World world;
+    PhaseTimes phaseSeconds{};
+
+    while (true) {
+        unsigned long i;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (next_ >= count) {
+                break;
+            }
+            i = next_++;
+            // Don't get so far ahead of the writer that our slot is in use.
+            changed_.wait(lock, [&]() { return i < written_ + window; });
+        }
+
+        // Derive the level the same way a game with this seed would.
+        Random streams(firstSeed_ + i);
+        world.create(height_, width_, streams.next(), maze_);
+        for (std::size_t p = 0; p < phaseSeconds.size(); p++) {
+            phaseSeconds[p] += world.phaseSeconds(static_cast<PHASE>(p));
+        }
+
+        std::ostringstream level;
+        writeVarint(level, firstSeed_ + i);
+        world.write(level);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            slots_[i % window] = level.str();
+            ready_[i % window] = true;
+        }
+        changed_.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::size_t p = 0; p < phaseSeconds.size(); p++) {
+        phaseSeconds_[p] += phaseSeconds[p];
+    }
+}
@@ -1,10 +1,233 @@
+#include <getopt.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "cursesview.h"
 #include "game.h"
+#include "levelbatch.h"
+#include "mazecarver.h"
+#include "scheduler.h"
+#include "version.h"
+#include "world.h"
+
+static void usage(const char* program) {
+    std::fprintf(stderr, "usage: %s [--size HEIGHTxWIDTH] [--maze ALGORITHM] [--endless]\n"
+        "              [--memory MB] [--radius N] [--seed N] [--tick-rate N]\n"
+        "              [--frame-rate N] [--hunt]\n"
+        "       %s --generate N [--threads T] [--out FILE] [--size HEIGHTxWIDTH]\n"
+        "              [--maze ALGORITHM] [--seed N]\n"
+        "  --size      dimensions of the maze, from %dx%d to %dx%d (default %dx%d)\n"
+        "  --maze      how to build the maze: simple, backtracker, growing-tree,\n"
+        "              kruskal, prim, wilson or eller (default %s)\n"
+        "  --endless   play a maze with no bottom (only the width of --size is used)\n"
+        "  --hunt      monsters near you wake up and come after you\n"
+        "  --memory    keep the maze in chunks of %dx%d, generated as they are needed,\n"
+        "              and hold only about MB megabytes of them in memory\n"
+        "  --radius    how far you can see, from 1 to %d tiles (default %d)\n"
+        "  --seed      play the maze generated from this number, or the first seed\n"
+        "              to generate\n"
+        "  --tick-rate game ticks per second, from 1 to %u (default %u)\n"
+        "  --frame-rate most times per second to draw the screen, from 1 to %u\n"
+        "              (default %u)\n"
+        "  --generate  write N levels with consecutive seeds instead of playing\n"
+        "  --threads   number of threads to generate with (default all cores)\n"
+        "  --out       file to write the levels to (default levels.tgwl, - for stdout)\n",
+        program, program,
+        MIN_MAP_SIZE, MIN_MAP_SIZE, MAX_MAP_SIZE, MAX_MAP_SIZE,
+        DEFAULT_MAP_HEIGHT, DEFAULT_MAP_WIDTH, MazeCarver::name(DEFAULT_MAZE),
+        CHUNKSIZE, CHUNKSIZE, MAX_FOV_RADIUS, DEFAULT_FOV_RADIUS,
+        MAX_RATE, DEFAULT_TICK_RATE, MAX_RATE, DEFAULT_FRAME_RATE);
+    exit(EXIT_FAILURE);
+}
+
+static bool parseSeed(const char* arg, std::uint64_t& seed) {
+    char extra;
+    return std::sscanf(arg, "%" SCNu64 "%c", &seed, &extra) == 1;
+}
+
+static bool parseCount(const char* arg, unsigned long& count) {
+    char extra;
+    return std::sscanf(arg, "%lu%c", &count, &extra) == 1 && count > 0;
+}
+
+static bool parseSize(const char* arg, int& height, int& width) {
+    char extra;
+    if (std::sscanf(arg, "%dx%d%c", &height, &width, &extra) != 2) {
+        return false;
+    }
+    return height >= MIN_MAP_SIZE && height <= MAX_MAP_SIZE &&
+        width >= MIN_MAP_SIZE && width <= MAX_MAP_SIZE;
+}
+
+static int generate(unsigned long count, unsigned long threads,
+const char* filename, int height, int width, MAZE maze, std::uint64_t seed) {
+    std::ofstream file;
+    bool toStdout = std::string(filename) == "-";
+    if (!toStdout) {
+        file.open(filename, std::ios::binary);
+        if (!file) {
+            std::cerr << "can't write " << filename << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+    std::ostream& out = toStdout ? std::cout : file;
+    std::ostream& report = toStdout ? std::cerr : std::cout;
+
+    LevelBatch batch(height, width, maze, seed);
+    batch.run(count, threads, out);
+    out.flush();
+    if (!out) {
+        std::cerr << "error writing " << filename << '\n';
+        return EXIT_FAILURE;
+    }
+
+    static const struct {
+        PHASE       phase;
+        const char* name;
+    } phases[] = {
+        { PHASE::GENERATE_MAZE, "generate maze" },
+        { PHASE::ADD_EXITS, "add exits" },
+        { PHASE::ADD_WALLS, "add walls" },
+        { PHASE::ADD_DOORS, "add doors" },
+        { PHASE::SPECIALIZE_WALLS, "specialize walls" },
+    };
+
+    report << count << ' ' << MazeCarver::name(maze) << " levels of "
+        << height << 'x' << width << " from seed " << seed << " on " << threads << " threads in "
+        << batch.seconds() << " s, " << count / batch.seconds()
+        << " levels/s\n";
+    for (auto& p : phases) {
+        report << "  " << p.name << ": "
+            << batch.phaseSeconds(p.phase) / count * 1e6 << " us/level\n";
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int main (int argc, char **argv) {
+    static const struct option options[] = {
+        { "endless", no_argument, nullptr, 'e' },
+        { "frame-rate", required_argument, nullptr, 'F' },
+        { "generate", required_argument, nullptr, 'g' },
+        { "hunt", no_argument, nullptr, 'H' },
+        { "maze", required_argument, nullptr, 'm' },
+        { "memory", required_argument, nullptr, 'M' },
+        { "out", required_argument, nullptr, 'o' },
+        { "radius", required_argument, nullptr, 'R' },
+        { "seed", required_argument, nullptr, 'r' },
+        { "size", required_argument, nullptr, 's' },
+        { "threads", required_argument, nullptr, 't' },
+        { "tick-rate", required_argument, nullptr, 'T' },
+        { nullptr, 0, nullptr, 0 }
+    };
+    int height = DEFAULT_MAP_HEIGHT;
+    int width = DEFAULT_MAP_WIDTH;
+    MAZE maze = DEFAULT_MAZE;
+    std::uint64_t seed = 0;
+    bool seeded = false;
+    bool endless = false;
+    bool hunting = false;
+    unsigned long megabytes = 0;
+    unsigned long radius = DEFAULT_FOV_RADIUS;
+    unsigned long tickRate = DEFAULT_TICK_RATE;
+    unsigned long frameRate = DEFAULT_FRAME_RATE;
+    unsigned long levels = 0;
+    unsigned long threads = std::max(std::thread::hardware_concurrency(), 1u);
+    const char* out = "levels.tgwl";
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "eF:g:Hm:M:o:r:R:s:t:T:", options, nullptr))
+    != -1) {
+        switch (opt) {
+        case 'e':
+            endless = true;
+            break;
+        case 'F':
+            if (!parseCount(optarg, frameRate) || frameRate > MAX_RATE) {
+                usage(argv[0]);
+            }
+            break;
+        case 'g':
+            if (!parseCount(optarg, levels)) {
+                usage(argv[0]);
+            }
+            break;
+        case 'H':
+            hunting = true;
+            break;
+        case 'm':
+            if (!MazeCarver::parse(optarg, maze)) {
+                usage(argv[0]);
+            }
+            break;
+        case 'M':
+            if (!parseCount(optarg, megabytes)) {
+                usage(argv[0]);
+            }
+            break;
+        case 'o':
+            out = optarg;
+            break;
+        case 'r':
+            if (!parseSeed(optarg, seed)) {
+                usage(argv[0]);
+            }
+            seeded = true;
+            break;
+        case 'R':
+            if (!parseCount(optarg, radius) || radius > MAX_FOV_RADIUS) {
+                usage(argv[0]);
+            }
+            break;
+        case 's':
+            if (!parseSize(optarg, height, width)) {
+                usage(argv[0]);
+            }
+            break;
+        case 't':
+            if (!parseCount(optarg, threads)) {
+                usage(argv[0]);
+            }
+            break;
+        case 'T':
+            if (!parseCount(optarg, tickRate) || tickRate > MAX_RATE) {
+                usage(argv[0]);
+            }
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
 
-const char *name = "The Girl Who Played With The Dragons Nest";
-const char *version = "1.2";
+    if (levels > 0) {
+        if (!seeded) {
+            std::random_device device;
+            seed = (static_cast<std::uint64_t>(device()) << 32) | device();
+        }
+        return generate(levels, threads, out, height, width, maze, seed);
+    }
 
-int main (int, char **) {
-    Game game;
+    std::unique_ptr<CursesView> view(new CursesView());
+    view->setRates(tickRate, frameRate);
+    Game game(std::move(view));
+    game.setWorldSize(height, width);
+    game.setMaze(maze);
+    game.setEndless(endless);
+    game.setChunkBudget(megabytes << 20);
+    game.setFovRadius(static_cast<int>(radius));
+    game.setHunting(hunting);
+    if (seeded) {
+        game.setSeed(seed);
+    }
 
-    return game.run(name, version);
+    return game.run(NAME, VERSION);
 }
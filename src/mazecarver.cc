@@ -0,0 +1,451 @@
+#include <cstdint>
+#include <numeric>
+#include <vector>
+#include "bitlayer.h"
+#include "mazecarver.h"
+#include "random.h"
+
+// Up, down, left and right in cells.
+static constexpr int DIRS[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+
+static constexpr const char* NAMES[] = { "simple", "backtracker",
+    "growing-tree", "kruskal", "prim", "wilson", "eller" };
+
+// Marks a cell in Eller's algorithm which is not yet in a set.
+static constexpr std::uint32_t NOSET = UINT32_MAX;
+
+static_assert(sizeof(NAMES) / sizeof(NAMES[0]) ==
+    static_cast<std::size_t>(MAZE::COUNT), "a maze algorithm has no name");
+
+struct MazeCarver::MazeCarverImpl {
+    MazeCarverImpl();
+    MazeCarverImpl(const MazeCarverImpl&)=delete;
+    MazeCarverImpl& operator=(const MazeCarverImpl&)=delete;
+    ~MazeCarverImpl()=default;
+    bool          neighbour(std::uint32_t cell, int dir, std::uint32_t& next) const;
+    int           unvisitedNeighbours(std::uint32_t cell, std::uint32_t next[4]) const;
+    void          openCell(std::uint32_t cell);
+    void          visit(std::uint32_t cell);
+    void          openWall(std::uint32_t from, std::uint32_t to);
+    std::uint32_t find(std::uint32_t cell);
+    void          simple();
+    void          backtracker();
+    void          growingTree();
+    void          kruskal();
+    void          prim();
+    void          wilson();
+    void          startEller();
+    void          ellerRow(bool last);
+
+    std::uint32_t                          rows_;
+    std::uint32_t                          cols_;
+    std::uint32_t                          cells_;
+    std::uint32_t                          row_;
+    Random*                                rng_;
+    const std::function<void(int, int)>*   open_;
+    BitLayer                               visited_;
+    std::vector<std::uint32_t>             list_;
+    std::vector<std::uint32_t>             parent_;
+    std::vector<std::uint8_t>              state_;
+    std::vector<std::uint32_t>             count_;
+};
+
+MazeCarver::MazeCarver() : impl_{new MazeCarver::MazeCarverImpl()} {
+}
+
+MazeCarver::~MazeCarver() {
+
+}
+
+void MazeCarver::carve(MAZE algorithm, int height, int width, Random& rng,
+const std::function<void(int, int)>& open) {
+    impl_->rows_ = static_cast<std::uint32_t>((height - 1) / 2);
+    impl_->cols_ = static_cast<std::uint32_t>((width - 1) / 2);
+    impl_->cells_ = impl_->rows_ * impl_->cols_;
+    impl_->rng_ = &rng;
+    impl_->open_ = &open;
+    impl_->visited_.assign(impl_->cells_, false);
+    impl_->list_.clear();
+
+    switch (algorithm) {
+    case MAZE::BACKTRACKER:
+        impl_->backtracker();
+        break;
+    case MAZE::GROWING_TREE:
+        impl_->growingTree();
+        break;
+    case MAZE::KRUSKAL:
+        impl_->kruskal();
+        break;
+    case MAZE::PRIM:
+        impl_->prim();
+        break;
+    case MAZE::WILSON:
+        impl_->wilson();
+        break;
+    case MAZE::ELLER:
+        impl_->startEller();
+        for (std::uint32_t row = 1; row < impl_->rows_; row++) {
+            impl_->ellerRow(false);
+        }
+        impl_->ellerRow(true);
+        break;
+    default:
+        impl_->simple();
+        break;
+    }
+
+    impl_->rng_ = nullptr;
+    impl_->open_ = nullptr;
+}
+
+void MazeCarver::startRows(int width) {
+    impl_->cols_ = static_cast<std::uint32_t>((width - 1) / 2);
+    impl_->startEller();
+}
+
+void MazeCarver::carveRow(Random& rng,
+const std::function<void(int, int)>& open) {
+    impl_->rng_ = &rng;
+    impl_->open_ = &open;
+    impl_->ellerRow(false);
+    impl_->rng_ = nullptr;
+    impl_->open_ = nullptr;
+}
+
+const char* MazeCarver::name(MAZE algorithm) {
+    return NAMES[static_cast<std::size_t>(algorithm)];
+}
+
+bool MazeCarver::parse(const std::string& name, MAZE& algorithm) {
+    for (std::size_t i = 0; i < static_cast<std::size_t>(MAZE::COUNT); i++) {
+        if (name == NAMES[i]) {
+            algorithm = static_cast<MAZE>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Private methods
+
+MazeCarver::MazeCarverImpl::MazeCarverImpl() : rows_{0}, cols_{0}, cells_{0},
+row_{0}, rng_{nullptr}, open_{nullptr}, visited_{}, list_{}, parent_{},
+state_{}, count_{} {
+}
+
+bool MazeCarver::MazeCarverImpl::neighbour(std::uint32_t cell, int dir,
+std::uint32_t& next) const {
+    std::int64_t row = cell / cols_ + DIRS[dir][0];
+    std::int64_t col = cell % cols_ + DIRS[dir][1];
+    if (row < 0 || row >= rows_ || col < 0 || col >= cols_) {
+        return false;
+    }
+    next = static_cast<std::uint32_t>(row * cols_ + col);
+    return true;
+}
+
+int MazeCarver::MazeCarverImpl::unvisitedNeighbours(std::uint32_t cell,
+std::uint32_t next[4]) const {
+    int n = 0;
+    for (int dir = 0; dir < 4; dir++) {
+        if (neighbour(cell, dir, next[n]) && !visited_.test(next[n])) {
+            n++;
+        }
+    }
+    return n;
+}
+
+void MazeCarver::MazeCarverImpl::openCell(std::uint32_t cell) {
+    (*open_)(static_cast<int>(1 + 2 * (cell / cols_)),
+        static_cast<int>(1 + 2 * (cell % cols_)));
+}
+
+void MazeCarver::MazeCarverImpl::visit(std::uint32_t cell) {
+    visited_.set(cell, true);
+    openCell(cell);
+}
+
+// The wall between two neighbouring cells is halfway between them.
+void MazeCarver::MazeCarverImpl::openWall(std::uint32_t from,
+std::uint32_t to) {
+    (*open_)(static_cast<int>(1 + from / cols_ + to / cols_),
+        static_cast<int>(1 + from % cols_ + to % cols_));
+}
+
+// Union-find root with path halving.
+std::uint32_t MazeCarver::MazeCarverImpl::find(std::uint32_t cell) {
+    while (parent_[cell] != cell) {
+        parent_[cell] = parent_[parent_[cell]];
+        cell = parent_[cell];
+    }
+    return cell;
+}
+
+// Algorithm based on VB/JS examples at
+// http://www.roguebasin.com/index.php?title=Simple_maze
+// Walks from a random cell which is already part of the maze until it gets
+// stuck, then picks another.  Most picks miss once the maze fills up, so it
+// gets slower much faster than the maze gets bigger.
+void MazeCarver::MazeCarverImpl::simple() {
+    std::vector<int> dirs = { 0, 1, 2, 3 };
+    std::uint32_t done = 0;
+
+    do {
+        std::uint32_t row = rng_->uniform(rows_);
+        std::uint32_t col = rng_->uniform(cols_);
+        std::uint32_t cell = row * cols_ + col;
+
+        // Start cell.
+        if (done == 0) {
+            visit(cell);
+        }
+
+        if (visited_.test(cell)) {
+            rng_->shuffle(dirs);
+
+            bool blocked = true;
+
+            do {
+                if (rng_->uniform(5) == 0) {
+                    rng_->shuffle(dirs);
+                }
+
+                blocked = true;
+                for (int i = 0; i < 4; i++) {
+                    std::uint32_t next;
+                    if (neighbour(cell, dirs[i], next) &&
+                    !visited_.test(next)) {
+                        visit(next);
+                        openWall(cell, next);
+                        cell = next;
+                        blocked = false;
+                        done++;
+                        break;
+                    }
+                }
+            } while (!blocked);
+        }
+    } while (done + 1 < cells_);
+}
+
+// Random depth-first search with an explicit stack.
+void MazeCarver::MazeCarverImpl::backtracker() {
+    std::uint32_t start = rng_->uniform(cells_);
+    visit(start);
+    list_.push_back(start);
+
+    while (!list_.empty()) {
+        std::uint32_t cell = list_.back();
+        std::uint32_t next[4];
+        int n = unvisitedNeighbours(cell, next);
+        if (n == 0) {
+            list_.pop_back();
+            continue;
+        }
+        std::uint32_t chosen = next[rng_->uniform(n)];
+        visit(chosen);
+        openWall(cell, chosen);
+        list_.push_back(chosen);
+    }
+}
+
+// Like the backtracker, but half the time it carries on from a random
+// active cell instead of the newest, which gives more and shorter branches.
+void MazeCarver::MazeCarverImpl::growingTree() {
+    std::uint32_t start = rng_->uniform(cells_);
+    visit(start);
+    list_.push_back(start);
+
+    while (!list_.empty()) {
+        std::size_t i = rng_->uniform(2) == 0 ? list_.size() - 1 :
+            rng_->uniform(static_cast<std::uint32_t>(list_.size()));
+        std::uint32_t cell = list_[i];
+        std::uint32_t next[4];
+        int n = unvisitedNeighbours(cell, next);
+        if (n == 0) {
+            list_[i] = list_.back();
+            list_.pop_back();
+            continue;
+        }
+        std::uint32_t chosen = next[rng_->uniform(n)];
+        visit(chosen);
+        openWall(cell, chosen);
+        list_.push_back(chosen);
+    }
+}
+
+// Opens every cell, then the walls in random order unless the cells on
+// either side are already connected.  list_ holds each wall as the cell
+// above or to the left of it times two, plus one for a wall below it.
+void MazeCarver::MazeCarverImpl::kruskal() {
+    parent_.resize(cells_);
+    std::iota(parent_.begin(), parent_.end(), 0);
+
+    for (std::uint32_t cell = 0; cell < cells_; cell++) {
+        visit(cell);
+        if (cell % cols_ + 1 < cols_) {
+            list_.push_back(cell * 2);
+        }
+        if (cell / cols_ + 1 < rows_) {
+            list_.push_back(cell * 2 + 1);
+        }
+    }
+    rng_->shuffle(list_);
+
+    for (auto wall : list_) {
+        std::uint32_t from = wall / 2;
+        std::uint32_t to = wall & 1 ? from + cols_ : from + 1;
+        std::uint32_t a = find(from);
+        std::uint32_t b = find(to);
+        if (a != b) {
+            parent_[b] = a;
+            openWall(from, to);
+        }
+    }
+}
+
+// Grows the maze from a random frontier cell each time.  state_ is 0 for
+// cells outside the maze and 1 for cells on the frontier.
+void MazeCarver::MazeCarverImpl::prim() {
+    state_.assign(cells_, 0);
+
+    std::uint32_t cell = rng_->uniform(cells_);
+    visit(cell);
+    while (true) {
+        for (int dir = 0; dir < 4; dir++) {
+            std::uint32_t next;
+            if (neighbour(cell, dir, next) && !visited_.test(next) &&
+            state_[next] == 0) {
+                state_[next] = 1;
+                list_.push_back(next);
+            }
+        }
+        if (list_.empty()) {
+            break;
+        }
+
+        std::size_t i = rng_->uniform(static_cast<std::uint32_t>(list_.size()));
+        cell = list_[i];
+        list_[i] = list_.back();
+        list_.pop_back();
+
+        std::uint32_t in[4];
+        int n = 0;
+        for (int dir = 0; dir < 4; dir++) {
+            if (neighbour(cell, dir, in[n]) && visited_.test(in[n])) {
+                n++;
+            }
+        }
+        visit(cell);
+        openWall(in[rng_->uniform(n)], cell);
+    }
+}
+
+// Loop-erased random walks from each cell outside the maze until they hit
+// it, which gives every possible maze the same chance.  state_ holds the
+// direction each walk last left a cell in.  The first walks have to find a
+// single cell so this is the slowest of the linear algorithms.
+void MazeCarver::MazeCarverImpl::wilson() {
+    state_.assign(cells_, 0);
+    visit(rng_->uniform(cells_));
+
+    for (std::uint32_t first = 0; first < cells_; first++) {
+        std::uint32_t cell = first;
+        while (!visited_.test(cell)) {
+            std::uint32_t next;
+            int dir;
+            do {
+                dir = static_cast<int>(rng_->uniform(4));
+            } while (!neighbour(cell, dir, next));
+            state_[cell] = static_cast<std::uint8_t>(dir);
+            cell = next;
+        }
+
+        cell = first;
+        while (!visited_.test(cell)) {
+            std::uint32_t next = 0;
+            neighbour(cell, state_[cell], next);
+            visit(cell);
+            openWall(cell, next);
+            cell = next;
+        }
+    }
+}
+
+// Eller's algorithm keeps the set each cell of the current row belongs to
+// in list_.  Set ids are below the number of columns and are reused from
+// row to row; parent_ is a union-find forest over them, state_ says whether
+// a set has a passage down yet and count_ how many of its cells are left.
+void MazeCarver::MazeCarverImpl::startEller() {
+    row_ = 0;
+    list_.resize(cols_);
+    std::iota(list_.begin(), list_.end(), 0);
+    parent_.resize(cols_);
+    std::iota(parent_.begin(), parent_.end(), 0);
+    state_.assign(cols_, 0);
+    count_.assign(cols_, 0);
+}
+
+// Joins neighbouring cells in different sets at random (or all of them in
+// the last row), then opens at least one passage down from each set.
+void MazeCarver::MazeCarverImpl::ellerRow(bool last) {
+    std::uint32_t base = row_++ * cols_;
+
+    for (std::uint32_t col = 0; col < cols_; col++) {
+        openCell(base + col);
+    }
+
+    for (std::uint32_t col = 0; col + 1 < cols_; col++) {
+        std::uint32_t a = find(list_[col]);
+        std::uint32_t b = find(list_[col + 1]);
+        if (a != b && (last || rng_->uniform(2) == 0)) {
+            parent_[b] = a;
+            openWall(base + col, base + col + 1);
+        }
+    }
+
+    if (last) {
+        return;
+    }
+
+    for (std::uint32_t col = 0; col < cols_; col++) {
+        list_[col] = find(list_[col]);
+        count_[list_[col]]++;
+    }
+
+    // The last cell of a set with no way down yet must have one.
+    for (std::uint32_t col = 0; col < cols_; col++) {
+        std::uint32_t set = list_[col];
+        count_[set]--;
+        if ((state_[set] == 0 && count_[set] == 0) || rng_->uniform(2) == 0) {
+            state_[set] = 1;
+            openWall(base + col, base + col + cols_);
+        } else {
+            list_[col] = NOSET;
+        }
+    }
+
+    // Cells below a passage stay in their set, the rest get unused ids.
+    for (std::uint32_t col = 0; col < cols_; col++) {
+        if (list_[col] != NOSET) {
+            count_[list_[col]] = 1;
+        }
+    }
+    std::uint32_t id = 0;
+    for (std::uint32_t col = 0; col < cols_; col++) {
+        if (list_[col] == NOSET) {
+            while (count_[id] != 0) {
+                id++;
+            }
+            list_[col] = id;
+            count_[id] = 1;
+        }
+    }
+
+    for (std::uint32_t set = 0; set < cols_; set++) {
+        parent_[set] = set;
+        state_[set] = 0;
+        count_[set] = 0;
+    }
+}
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cctype>
+
+#include "messagelog.h"
+
+static bool isSpace(char c) {
+    return std::isspace(static_cast<unsigned char>(c));
+}
+
+MessageLog::MessageLog(std::size_t history, std::size_t width) :
+text_(std::max<std::size_t>(history, 1) * MESSAGE_LENGTH),
+lengths_(std::max<std::size_t>(history, 1)),
+lines_(std::max<std::size_t>(history, 1) * LINES_PER_MESSAGE),
+width_{std::max<std::size_t>(width, 1)}, nextMessage_{0}, messageCount_{0},
+nextLine_{0}, lineCount_{0} {
+}
+
+void MessageLog::add(std::string_view message) {
+    std::size_t slot = nextMessage_;
+
+    // The oldest message is about to be overwritten so its lines, which are
+    // the oldest ones if any of them are left, have to go.
+    if (messageCount_ == lengths_.size()) {
+        while (lineCount_ > 0) {
+            std::size_t oldest = (nextLine_ + lines_.size() - lineCount_) %
+                lines_.size();
+            if (lines_[oldest].message != slot) {
+                break;
+            }
+            lineCount_--;
+        }
+    }
+
+    std::size_t length = std::min(message.size(), MESSAGE_LENGTH);
+    std::copy_n(message.data(), length, text_.begin() + slot * MESSAGE_LENGTH);
+    lengths_[slot] = static_cast<std::uint16_t>(length);
+
+    nextMessage_ = (nextMessage_ + 1) % lengths_.size();
+    messageCount_ = std::min(messageCount_ + 1, lengths_.size());
+    wrap(slot);
+}
+
+void MessageLog::clear() {
+    nextMessage_ = messageCount_ = 0;
+    nextLine_ = lineCount_ = 0;
+}
+
+std::size_t MessageLog::lines() const {
+    return lineCount_;
+}
+
+// The newest line is 0.
+std::string_view MessageLog::line(std::size_t back) const {
+    if (back >= lineCount_) {
+        return std::string_view();
+    }
+    const Line& l = lines_[(nextLine_ + lines_.size() - 1 - back) % lines_.size()];
+    return std::string_view(text_.data() + l.message * MESSAGE_LENGTH + l.begin,
+        l.length);
+}
+
+std::size_t MessageLog::messages() const {
+    return messageCount_;
+}
+
+// Wraps everything again, oldest first, if the width is different.
+void MessageLog::setWidth(std::size_t width) {
+    width = std::max<std::size_t>(width, 1);
+    if (width == width_) {
+        return;
+    }
+    width_ = width;
+
+    nextLine_ = lineCount_ = 0;
+    std::size_t size = lengths_.size();
+    for (std::size_t i = messageCount_; i > 0; i--) {
+        wrap((nextMessage_ + size - i) % size);
+    }
+}
+
+std::size_t MessageLog::width() const {
+    return width_;
+}
+
+// Greedy word wrap in place.  Words are broken only if they don't fit on a
+// line of their own and a newline always starts a new line.
+void MessageLog::wrap(std::size_t message) {
+    const char* text = text_.data() + message * MESSAGE_LENGTH;
+    std::size_t length = lengths_[message];
+    std::size_t pos = 0;
+
+    while (true) {
+        while (pos < length && isSpace(text[pos])) {
+            pos++;
+        }
+        if (pos == length) {
+            break;
+        }
+
+        std::size_t begin = pos;
+        std::size_t end = pos;
+        while (pos < length && text[pos] != '\n') {
+            std::size_t word = pos;
+            while (pos < length && !isSpace(text[pos])) {
+                pos++;
+            }
+            if (pos - begin > width_) {
+                if (end == begin) {
+                    end = begin + width_;
+                }
+                pos = std::max(word, end);
+                break;
+            }
+            end = pos;
+            while (pos < length && isSpace(text[pos]) && text[pos] != '\n') {
+                pos++;
+            }
+        }
+
+        lines_[nextLine_] = Line{ static_cast<std::uint32_t>(message),
+            static_cast<std::uint16_t>(begin),
+            static_cast<std::uint16_t>(end - begin) };
+        nextLine_ = (nextLine_ + 1) % lines_.size();
+        lineCount_ = std::min(lineCount_ + 1, lines_.size());
+    }
+}
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "item.h"
+#include "monsters.h"
+#include "pathing.h"
+#include "player.h"
+#include "random.h"
+#include "world.h"
+
+// A turn is TURN units of time.  A monster with speed s acts every
+// TURN * 100 / s units.
+static constexpr std::uint32_t TURN = 100;
+
+static constexpr int STEPS[8][2] = {
+    { -1,  0 }, {  1,  0 }, {  0, -1 }, {  0,  1 },
+    { -1, -1 }, { -1,  1 }, {  1, -1 }, {  1,  1 },
+};
+
+// An entry in the turn queue.  It only counts if its ticket is the one its
+// monster's Actor has; waking or sleeping a monster leaves the old entry
+// behind to be thrown away when it comes up.
+struct Due {
+    std::uint64_t due;
+    std::uint32_t ticket;
+    Entity        entity;
+};
+
+// Whether a comes after b.  Monsters due at the same time go in the order
+// they were queued.
+static bool later(const Due& a, const Due& b) {
+    return a.due != b.due ? a.due > b.due : a.ticket > b.ticket;
+}
+
+static int distance(int row, int col, int toRow, int toCol) {
+    return std::max(std::abs(toRow - row), std::abs(toCol - col));
+}
+
+struct Monsters::MonstersImpl {
+    MonstersImpl();
+    ~MonstersImpl()=default;
+    void wakeAround(World& world, int row, int col);
+    void schedule(Entity entity, Actor& actor);
+    void sleepFarFrom(Entities& entities, int row, int col);
+    int  act(World& world, Player& player, Pathing& pathing, Random& rng,
+             Entity entity, int defenseBonus,
+             std::function<void(std::string_view)>& message);
+    void step(World& world, Pathing& pathing, int row, int col, int toRow,
+             int toCol);
+
+    std::vector<Due> queue_;
+    std::uint64_t    now_;
+    std::uint32_t    tickets_;
+    int              lastRow_;
+    int              lastCol_;
+    MonsterStats     stats_;
+};
+
+Monsters::Monsters() : impl_{new Monsters::MonstersImpl()} {
+}
+
+Monsters::~Monsters() {
+
+}
+
+// A turn's worth of time passes after the player has done something.
+// engaged is a monster the player has just fought, which has had its swing
+// at them already.  Returns how many times the player was attacked.
+int Monsters::turn(World& world, Player& player, Pathing& pathing, Random& rng,
+Entity engaged, std::function<void(std::string_view)> message) {
+    Entities& entities = world.entities();
+    int row = world.playerRow();
+    int col = world.playerCol();
+    if (row != impl_->lastRow_ || col != impl_->lastCol_) {
+        impl_->wakeAround(world, row, col);
+        impl_->lastRow_ = row;
+        impl_->lastCol_ = col;
+    }
+
+    int defenseBonus = 0;
+    player.foreach_wielded([&](Item item) {
+        if (Armament* armament = item.armament()) {
+            defenseBonus += armament->defenseBonus();
+        }
+    });
+
+    impl_->stats_.turns++;
+    impl_->now_ += TURN;
+    int attacks = 0;
+    auto& queue = impl_->queue_;
+    while (!queue.empty() && queue.front().due <= impl_->now_ &&
+    player.health() > 0) {
+        std::pop_heap(queue.begin(), queue.end(), later);
+        Due next = queue.back();
+        queue.pop_back();
+
+        const Actor* actor = entities.actors().find(next.entity);
+        if (actor == nullptr || actor->ticket != next.ticket) {
+            continue;
+        }
+        impl_->stats_.actions++;
+        if (next.entity != engaged) {
+            attacks += impl_->act(world, player, pathing, rng, next.entity,
+                defenseBonus, message);
+        }
+
+        // Acting can move things about in the store, so look again.
+        Actor* again = entities.actors().find(next.entity);
+        if (again != nullptr && again->ticket == next.ticket) {
+            again->due += again->delay;
+            impl_->schedule(next.entity, *again);
+        }
+    }
+
+    impl_->sleepFarFrom(entities, world.playerRow(), world.playerCol());
+    impl_->stats_.awake = entities.actors().size();
+    return attacks;
+}
+
+MonsterStats Monsters::stats() const {
+    return impl_->stats_;
+}
+
+// private methods
+
+Monsters::MonstersImpl::MonstersImpl() : queue_{}, now_{0}, tickets_{0},
+lastRow_{INT_MIN}, lastCol_{INT_MIN}, stats_{} {
+}
+
+// Only needs doing when the player has moved, and then only looks at the
+// items in the square around them.
+void Monsters::MonstersImpl::wakeAround(World& world, int row, int col) {
+    SparseSet<Actor>& actors = world.entities().actors();
+    world.foreach_item(row - WAKE_RADIUS, col - WAKE_RADIUS,
+    2 * WAKE_RADIUS + 1, 2 * WAKE_RADIUS + 1, [&](int, int, Item item) {
+        int speed = item.archetype().speed;
+        if (speed == 0 || item.combat() == nullptr ||
+        actors.has(item.entity())) {
+            return;
+        }
+        std::uint32_t delay = TURN * 100 / static_cast<std::uint32_t>(speed);
+        schedule(item.entity(), actors.insert(item.entity(),
+            Actor{now_ + delay, 0, delay}));
+        stats_.woken++;
+    });
+}
+
+void Monsters::MonstersImpl::schedule(Entity entity, Actor& actor) {
+    actor.ticket = ++tickets_;
+    queue_.push_back(Due{actor.due, actor.ticket, entity});
+    std::push_heap(queue_.begin(), queue_.end(), later);
+}
+
+// Removing an Actor moves the last one into its place, so going backwards
+// sees every one once.
+void Monsters::MonstersImpl::sleepFarFrom(Entities& entities, int row,
+int col) {
+    SparseSet<Actor>& actors = entities.actors();
+    const std::vector<Entity>& awake = actors.entities();
+    for (std::size_t i = awake.size(); i-- > 0; ) {
+        Entity entity = awake[i];
+        const Position* position = entities.positions().find(entity);
+        if (position == nullptr ||
+        distance(position->row, position->col, row, col) > SLEEP_RADIUS) {
+            actors.erase(entity);
+            stats_.slept++;
+        }
+    }
+}
+
+// A monster next to the player attacks them, the same way as when the player
+// fights it.  Any other steps towards them if it can.  Returns 1 for an
+// attack and 0 otherwise.
+int Monsters::MonstersImpl::act(World& world, Player& player, Pathing& pathing,
+Random& rng, Entity entity, int defenseBonus,
+std::function<void(std::string_view)>& message) {
+    Entities& entities = world.entities();
+    const Position* position = entities.positions().find(entity);
+    Combat* monster = entities.combat().find(entity);
+    if (position == nullptr || monster == nullptr) {
+        return 0;
+    }
+
+    int row = world.playerRow();
+    int col = world.playerCol();
+    if (distance(position->row, position->col, row, col) > 1) {
+        step(world, pathing, position->row, position->col, row, col);
+        return 0;
+    }
+
+    const Archetype& kind = archetype(entities.archetype(entity));
+    char buffer[80];
+    if (monster->attack(rng) <= player.defend(rng) + defenseBonus) {
+        std::snprintf(buffer, sizeof buffer, "The %.*s misses you.",
+            static_cast<int>(kind.name.size()), kind.name.data());
+        message(buffer);
+        return 1;
+    }
+
+    std::snprintf(buffer, sizeof buffer, "The %.*s hits you.",
+        static_cast<int>(kind.name.size()), kind.name.data());
+    message(buffer);
+    player.setHealth(-1);
+    if (kind.type == ITEMTYPE::WIZARD) {
+        player.setKeepFighting(false);
+        world.returnToStart();
+    } else if (kind.type == ITEMTYPE::DRAGON) {
+        player.setHealth(-2);
+    }
+    return 1;
+}
+
+// Moves to whichever empty tile next to it is nearest the player by the
+// player's distance field, as long as that is nearer than it is now.  Ties
+// go to the one nearest as the crow flies.  Monsters can't get past doors
+// or items, so they are easy to shut out.
+void Monsters::MonstersImpl::step(World& world, Pathing& pathing, int row,
+int col, int toRow, int toCol) {
+    std::uint32_t here = pathing.distance(GOAL::PLAYER, row, col);
+    if (here == UNREACHABLE) {
+        return;
+    }
+    std::uint32_t best = here;
+    int bestSquare = INT_MAX;
+    int bestRow = row;
+    int bestCol = col;
+    for (auto& s : STEPS) {
+        int r = row + s[0];
+        int c = col + s[1];
+        std::uint32_t d = pathing.distance(GOAL::PLAYER, r, c);
+        int square = (toRow - r) * (toRow - r) + (toCol - c) * (toCol - c);
+        if (d >= here || d > best || (d == best && square >= bestSquare)) {
+            continue;
+        }
+        if (world.itemAt(r, c)) {
+            continue;
+        }
+        best = d;
+        bestRow = r;
+        bestCol = c;
+        bestSquare = square;
+    }
+
+    if (bestRow != row || bestCol != col) {
+        world.moveItem(row, col, bestRow, bestCol);
+    }
+}
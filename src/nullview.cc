@@ -0,0 +1,118 @@
+#include <cctype>
+
+#include "keymap.h"
+#include "nullview.h"
+
+struct NullView::NullViewImpl {
+    explicit NullViewImpl(std::string script);
+    ~NullViewImpl()=default;
+
+    bool nextKey(int& key);
+
+    Keymap                  keymap_;
+    std::string             script_;
+    std::string::size_type  next_;
+};
+
+NullView::NullView(std::string script) :
+    impl_ { new NullView::NullViewImpl(script) } {
+}
+
+NullView::~NullView() {
+
+}
+
+void NullView::alert() {
+}
+
+STATE NullView::draw(World& /* world */, Player& /* player */) {
+    return STATE::COMMAND;
+}
+
+void NullView::end() {
+}
+
+STATE NullView::handleTopLevelInput(Game* game) {
+    int c;
+
+    if (impl_->nextKey(c)) {
+        return impl_->keymap_.command(c, game);
+    }
+
+    return STATE::QUIT;
+}
+
+DIRECTION NullView::handleDirectionInput(Game* /* game */) {
+    int c;
+
+    if (impl_->nextKey(c)) {
+        return impl_->keymap_.direction(c);
+    }
+
+    return DIRECTION::CANCELLED;
+}
+
+int NullView::handleNumericalInput(Game* /* game */) {
+    int c;
+
+    if (impl_->nextKey(c)) {
+        c -= '0';
+        if (c > 0 || c <= 9) {
+            return c;
+        }
+    }
+    return 0;
+}
+
+bool NullView::handleBooleanInput(Game* /* game */) {
+    int c;
+
+    if (impl_->nextKey(c)) {
+        return toupper(c) == 'Y';
+    }
+
+    // Out of script; say yes so a pending quit prompt ends the game.
+    return true;
+}
+
+void NullView::init(std::string /* titleText */) {
+}
+
+void NullView::message(std::string_view /* msg */) {
+}
+
+void NullView::pause(Game* /* game */) {
+    int c;
+
+    while (impl_->nextKey(c)) {
+        if (c == ' ') {
+            return;
+        }
+    }
+}
+
+void NullView::refresh() {
+}
+
+void NullView::resize(World& /* world */) {
+}
+
+void NullView::shell() {
+}
+
+// Private methods
+
+NullView::NullViewImpl::NullViewImpl(std::string script) : keymap_{},
+script_{script}, next_{0} {
+}
+
+bool NullView::NullViewImpl::nextKey(int& key) {
+    // Line breaks only serve to make scripts readable.
+    while (next_ < script_.length()) {
+        key = static_cast<unsigned char>(script_[next_++]);
+        if (key != '\n' && key != '\r') {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,536 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "item.h"
+#include "pathing.h"
+#include "world.h"
+
+static constexpr int STEPS[8][2] = {
+    { -1,  0 }, {  1,  0 }, {  0, -1 }, {  0,  1 },
+    { -1, -1 }, { -1,  1 }, {  1, -1 }, {  1,  1 },
+};
+
+// What a field knows about a tile: whether it can be walked over, whether
+// it is one of the goals and whether there is a known trap on it.
+static constexpr std::uint8_t OPEN    = 1;
+static constexpr std::uint8_t TARGET  = 2;
+static constexpr std::uint8_t TRAPPED = 4;
+
+// Traps can be stepped over carefully, but a way round is worth taking if
+// it is no more than this many steps longer.
+static constexpr std::uint32_t TRAP_STEPS = 10;
+
+// What it costs to step onto a tile in a given state.
+static std::uint32_t cost(std::uint8_t state) {
+    return state & TRAPPED ? TRAP_STEPS : 1;
+}
+
+// Past this many changes waiting it is quicker to start again.
+static constexpr std::size_t MAX_CHANGES = 64;
+
+// A rectangle of tiles.  Bottom and right are one past the end.
+struct Area {
+    int top;
+    int left;
+    int bottom;
+    int right;
+};
+
+static bool same(const Area& a, const Area& b) {
+    return a.top == b.top && a.left == b.left && a.bottom == b.bottom &&
+        a.right == b.right;
+}
+
+// One goal's distances over the window it covers, and the areas which have
+// changed since they were worked out.
+struct Field {
+    bool                       built;
+    Area                       window;
+    int                        centerRow;
+    int                        centerCol;
+    std::vector<std::uint32_t> distances;
+    std::vector<std::uint8_t>  states;
+    std::vector<Area>          changes;
+};
+
+// A tile waiting to be settled, by its distance and index in the window.
+typedef std::pair<std::uint32_t, std::uint32_t> Entry;
+
+struct Pathing::PathingImpl {
+    explicit PathingImpl(World* world);
+    PathingImpl(const PathingImpl&)=delete;
+    PathingImpl& operator=(const PathingImpl&)=delete;
+    ~PathingImpl()=default;
+    Field&       sync(GOAL goal);
+    void         note(Field& field, Area area);
+    std::uint8_t open(int row, int col);
+    std::uint8_t stateOf(GOAL goal, int row, int col);
+    void         rebuild(GOAL goal, Field& field, Area window);
+    void         update(GOAL goal, Field& field);
+    void         seed(Field& field, std::uint32_t i);
+    void         settle(Field& field);
+
+    World*                     world_;
+    std::array<Field, static_cast<std::size_t>(GOAL::COUNT)> fields_;
+    std::vector<Entry>         heap_;
+    std::vector<std::uint32_t> queue_;
+    std::vector<std::uint32_t> costs_;
+    std::vector<std::uint32_t> lowered_;
+    std::vector<std::uint8_t>  affected_;
+    PathingStats               stats_;
+};
+
+Pathing::Pathing(World& world) : impl_{new Pathing::PathingImpl(&world)} {
+}
+
+Pathing::~Pathing() {
+
+}
+
+// Throws the fields away, for a new level.
+void Pathing::reset() {
+    for (auto& field : impl_->fields_) {
+        field.built = false;
+        field.changes.clear();
+    }
+}
+
+// A door has opened or closed, or something else has changed whether the
+// tile can be walked over.
+void Pathing::changed(int row, int col) {
+    for (auto& field : impl_->fields_) {
+        impl_->note(field, Area{row, col, row + 1, col + 1});
+    }
+}
+
+// The player has looked around from here, so tiles up to radius away may
+// have been seen for the first time.  That moves the frontier up to a tile
+// further out.
+void Pathing::looked(int row, int col, int radius) {
+    Field& field = impl_->fields_[static_cast<std::size_t>(GOAL::FRONTIER)];
+    Area area{row - radius - 1, col - radius - 1, row + radius + 2,
+        col + radius + 2};
+    if (field.changes.empty() || !same(field.changes.back(), area)) {
+        impl_->note(field, area);
+    }
+}
+
+// How many steps it is from here to the nearest tile of the goal, or
+// UNREACHABLE if there is no way there or here is outside the field.
+std::uint32_t Pathing::distance(GOAL goal, int row, int col) {
+    Field& field = impl_->sync(goal);
+    const Area& w = field.window;
+    if (row < w.top || row >= w.bottom || col < w.left || col >= w.right) {
+        return UNREACHABLE;
+    }
+    return field.distances[static_cast<std::size_t>(row - w.top) *
+        static_cast<std::size_t>(w.right - w.left) + (col - w.left)];
+}
+
+// The first step from here towards the goal.  Returns false if there is no
+// way there or here is already a goal tile.
+bool Pathing::next(GOAL goal, int row, int col, int& toRow, int& toCol) {
+    std::uint32_t best = distance(goal, row, col);
+    if (best == UNREACHABLE) {
+        return false;
+    }
+    bool found = false;
+    for (auto& s : STEPS) {
+        std::uint32_t d = distance(goal, row + s[0], col + s[1]);
+        if (d < best) {
+            best = d;
+            toRow = row + s[0];
+            toCol = col + s[1];
+            found = true;
+        }
+    }
+    return found;
+}
+
+// The way from the player down the goal's field, a step at a time.
+bool Pathing::route(GOAL goal, std::vector<Position>& path) {
+    path.clear();
+    int row = impl_->world_->playerRow();
+    int col = impl_->world_->playerCol();
+    if (distance(goal, row, col) == UNREACHABLE) {
+        return false;
+    }
+    int toRow;
+    int toCol;
+    while (next(goal, row, col, toRow, toCol)) {
+        row = toRow;
+        col = toCol;
+        path.push_back(Position{row, col});
+    }
+    return true;
+}
+
+// A search over the tiles the player has seen, out from where they are
+// until it comes to a tile for which goal is true, for places there is no
+// field for.  The path is the tiles to step on in turn.  Returns false if
+// no such tile can be reached.
+bool Pathing::travel(std::function<bool(int, int)> goal,
+std::vector<Position>& path) {
+    World& world = *impl_->world_;
+    std::uint64_t width = static_cast<std::uint64_t>(world.width());
+    auto key = [width](int row, int col) {
+        return static_cast<std::uint64_t>(row) * width +
+            static_cast<std::uint64_t>(col);
+    };
+
+    struct Visit {
+        std::uint32_t distance;
+        std::uint64_t from;
+    };
+    std::unordered_map<std::uint64_t, Visit> visits;
+    std::vector<std::pair<std::uint32_t, std::uint64_t>> heap;
+    auto later = std::greater<std::pair<std::uint32_t, std::uint64_t>>();
+    std::uint64_t start = key(world.playerRow(), world.playerCol());
+    visits[start] = Visit{0, start};
+    heap.emplace_back(0, start);
+
+    path.clear();
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        auto next = heap.back();
+        heap.pop_back();
+        if (next.first != visits[next.second].distance) {
+            continue;
+        }
+        int row = static_cast<int>(next.second / width);
+        int col = static_cast<int>(next.second % width);
+        if (goal(row, col)) {
+            for (std::uint64_t at = next.second; at != start;
+            at = visits[at].from) {
+                path.push_back(Position{static_cast<int>(at / width),
+                    static_cast<int>(at % width)});
+            }
+            std::reverse(path.begin(), path.end());
+            return true;
+        }
+
+        for (auto& s : STEPS) {
+            int r = row + s[0];
+            int c = col + s[1];
+            if (r < world.firstRow() || r >= world.height() || c < 0 ||
+            c >= world.width() || !world.tileAt(r, c).seen()) {
+                continue;
+            }
+            std::uint8_t state = impl_->open(r, c);
+            if (state == 0) {
+                continue;
+            }
+            std::uint32_t d = next.first + cost(state);
+            auto found = visits.find(key(r, c));
+            if (found == visits.end() || found->second.distance > d) {
+                visits[key(r, c)] = Visit{d, next.second};
+                heap.emplace_back(d, key(r, c));
+                std::push_heap(heap.begin(), heap.end(), later);
+            }
+        }
+    }
+    return false;
+}
+
+PathingStats Pathing::stats() const {
+    return impl_->stats_;
+}
+
+// private methods
+
+Pathing::PathingImpl::PathingImpl(World* world) : world_{world}, fields_{},
+heap_{}, queue_{}, costs_{}, lowered_{}, affected_{}, stats_{} {
+}
+
+// Brings a field up to date.  The player field follows the player about,
+// so it is built again whenever they move; the others only move their
+// windows once the player gets halfway to the edge.
+Field& Pathing::PathingImpl::sync(GOAL goal) {
+    Field& field = fields_[static_cast<std::size_t>(goal)];
+    World& world = *world_;
+    int row = world.playerRow();
+    int col = world.playerCol();
+
+    Area window{world.firstRow(), 0, world.height(), world.width()};
+    bool recentre = !field.built;
+    int centerRow = row;
+    int centerCol = col;
+    if (goal == GOAL::PLAYER || world.endless() || world.chunked() ||
+    static_cast<std::size_t>(world.height()) * world.width() > FIELD_TILES) {
+        int radius = goal == GOAL::PLAYER ? PLAYER_FIELD_RADIUS : FIELD_RADIUS;
+        int slack = goal == GOAL::PLAYER ? 0 : radius / 2;
+        recentre = recentre || std::abs(row - field.centerRow) > slack ||
+            std::abs(col - field.centerCol) > slack;
+        if (!recentre) {
+            centerRow = field.centerRow;
+            centerCol = field.centerCol;
+        }
+        window = Area{std::max(centerRow - radius, window.top),
+            std::max(centerCol - radius, window.left),
+            std::min(centerRow + radius + 1, window.bottom),
+            std::min(centerCol + radius + 1, window.right)};
+    }
+
+    if (recentre || !same(window, field.window)) {
+        field.centerRow = centerRow;
+        field.centerCol = centerCol;
+        rebuild(goal, field, window);
+    } else if (!field.changes.empty()) {
+        update(goal, field);
+    }
+    return field;
+}
+
+void Pathing::PathingImpl::note(Field& field, Area area) {
+    if (!field.built) {
+        return;
+    }
+    if (field.changes.size() >= MAX_CHANGES) {
+        field.built = false;
+        field.changes.clear();
+        return;
+    }
+    field.changes.push_back(area);
+}
+
+// Closed doors are as good as walls.  A trap which hasn't been sprung looks
+// like any other floor, so only sprung ones cost extra.
+std::uint8_t Pathing::PathingImpl::open(int row, int col) {
+    if (!world_->tileAt(row, col).passable()) {
+        return 0;
+    }
+    Item item = world_->itemAt(row, col);
+    if (!item) {
+        return OPEN;
+    }
+    if (const DoorState* door = item.door()) {
+        return door->open ? OPEN : 0;
+    }
+    const TrapState* trap = item.trap();
+    return trap && trap->sprung ? OPEN | TRAPPED : OPEN;
+}
+
+std::uint8_t Pathing::PathingImpl::stateOf(GOAL goal, int row, int col) {
+    World& world = *world_;
+    switch (goal) {
+    case GOAL::PLAYER:
+        if (row == world.playerRow() && col == world.playerCol()) {
+            return OPEN | TARGET;
+        }
+        return open(row, col);
+
+    case GOAL::EXIT:
+        if (!world.endless() && row == world.height() - 1 &&
+        col == world.endCol()) {
+            return OPEN | TARGET;
+        }
+        return open(row, col);
+
+    case GOAL::FRONTIER: {
+        std::uint8_t state = world.tileAt(row, col).seen() ? open(row, col) : 0;
+        if (state == 0) {
+            return 0;
+        }
+        for (auto& s : STEPS) {
+            int r = row + s[0];
+            int c = col + s[1];
+            if (r >= world.firstRow() && r < world.height() && c >= 0 &&
+            c < world.width() && !world.tileAt(r, c).seen()) {
+                return state | TARGET;
+            }
+        }
+        return state;
+    }
+
+    default:
+        return 0;
+    }
+}
+
+// Dijkstra's algorithm out from every goal tile at once.
+void Pathing::PathingImpl::rebuild(GOAL goal, Field& field, Area window) {
+    int width = window.right - window.left;
+    std::size_t size = static_cast<std::size_t>(window.bottom - window.top) *
+        static_cast<std::size_t>(width);
+    field.built = true;
+    field.window = window;
+    field.changes.clear();
+    field.distances.assign(size, UNREACHABLE);
+    field.states.resize(size);
+
+    heap_.clear();
+    std::uint32_t i = 0;
+    for (int row = window.top; row < window.bottom; row++) {
+        for (int col = window.left; col < window.right; col++, i++) {
+            field.states[i] = stateOf(goal, row, col);
+            if (field.states[i] & TARGET) {
+                field.distances[i] = 0;
+                heap_.emplace_back(0, i);
+            }
+        }
+    }
+    settle(field);
+
+    stats_.rebuilds++;
+}
+
+// Tiles which have been opened up or become goals can only bring distances
+// down, so they are seeded and the fall spread out from them.  Tiles which
+// have been shut or stopped being goals may push up the distances of every
+// tile whose shortest way went through them.  Those are found by following
+// distances up from the changed tiles, forgotten, and seeded again from the
+// neighbours which weren't affected.
+void Pathing::PathingImpl::update(GOAL goal, Field& field) {
+    const Area& window = field.window;
+    int width = window.right - window.left;
+    affected_.resize(field.states.size());
+    queue_.clear();
+    costs_.clear();
+    lowered_.clear();
+    heap_.clear();
+
+    for (auto& area : field.changes) {
+        for (int row = std::max(area.top, window.top);
+        row < std::min(area.bottom, window.bottom); row++) {
+            for (int col = std::max(area.left, window.left);
+            col < std::min(area.right, window.right); col++) {
+                std::uint32_t i = static_cast<std::uint32_t>(
+                    (row - window.top) * width + (col - window.left));
+                std::uint8_t before = field.states[i];
+                std::uint8_t after = stateOf(goal, row, col);
+                if (before == after) {
+                    continue;
+                }
+                field.states[i] = after;
+                // A tile costing more to step onto, like a trap being
+                // sprung, raises whatever was reached through it just as
+                // losing a bit does.  Sprung traps gain a bit as well, so
+                // they are lowered again from their neighbours after.
+                bool raised = (before & ~after) || cost(after) > cost(before);
+                if (raised && !affected_[i]) {
+                    affected_[i] = 1;
+                    queue_.push_back(i);
+                    costs_.push_back(cost(before));
+                }
+                if (after & ~before) {
+                    lowered_.push_back(i);
+                }
+            }
+        }
+    }
+    field.changes.clear();
+
+    for (std::size_t head = 0; head < queue_.size(); head++) {
+        std::uint32_t here = queue_[head];
+        if (field.distances[here] == UNREACHABLE) {
+            continue;
+        }
+        int row = static_cast<int>(here) / width;
+        int col = static_cast<int>(here) % width;
+        std::uint32_t d = field.distances[here] + costs_[head];
+        for (auto& s : STEPS) {
+            int r = row + s[0];
+            int c = col + s[1];
+            if (r < 0 || r >= window.bottom - window.top || c < 0 ||
+            c >= width) {
+                continue;
+            }
+            std::uint32_t j = static_cast<std::uint32_t>(r * width + c);
+            if (!affected_[j] && field.distances[j] == d) {
+                affected_[j] = 1;
+                queue_.push_back(j);
+                costs_.push_back(cost(field.states[j]));
+            }
+        }
+    }
+
+    for (std::uint32_t i : queue_) {
+        field.distances[i] = UNREACHABLE;
+    }
+    for (std::uint32_t i : queue_) {
+        seed(field, i);
+        affected_[i] = 0;
+    }
+    for (std::uint32_t i : lowered_) {
+        seed(field, i);
+    }
+    settle(field);
+
+    stats_.updates++;
+}
+
+// Gives a tile the best distance its neighbours offer and queues it to pass
+// that on, if that is better than what it has.
+void Pathing::PathingImpl::seed(Field& field, std::uint32_t i) {
+    if (!(field.states[i] & OPEN)) {
+        return;
+    }
+    const Area& window = field.window;
+    int width = window.right - window.left;
+    int row = static_cast<int>(i) / width;
+    int col = static_cast<int>(i) % width;
+    std::uint32_t best = UNREACHABLE;
+    if (field.states[i] & TARGET) {
+        best = 0;
+    } else {
+        for (auto& s : STEPS) {
+            int r = row + s[0];
+            int c = col + s[1];
+            if (r < 0 || r >= window.bottom - window.top || c < 0 ||
+            c >= width) {
+                continue;
+            }
+            std::size_t j = static_cast<std::size_t>(r * width + c);
+            if (field.distances[j] != UNREACHABLE) {
+                best = std::min(best,
+                    field.distances[j] + cost(field.states[j]));
+            }
+        }
+    }
+
+    if (best < field.distances[i]) {
+        field.distances[i] = best;
+        heap_.emplace_back(best, i);
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+    }
+}
+
+// Dijkstra's algorithm from whatever has been seeded.  Traps cost more than
+// other tiles and seeds can start at any distance, so it takes a priority
+// queue rather than a plain one.
+void Pathing::PathingImpl::settle(Field& field) {
+    const Area& window = field.window;
+    int width = window.right - window.left;
+    while (!heap_.empty()) {
+        std::pop_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+        Entry next = heap_.back();
+        heap_.pop_back();
+        if (next.first != field.distances[next.second]) {
+            continue;
+        }
+        stats_.visited++;
+
+        int row = static_cast<int>(next.second) / width;
+        int col = static_cast<int>(next.second) % width;
+        std::uint32_t d = next.first + cost(field.states[next.second]);
+        for (auto& s : STEPS) {
+            int r = row + s[0];
+            int c = col + s[1];
+            if (r < 0 || r >= window.bottom - window.top || c < 0 ||
+            c >= width) {
+                continue;
+            }
+            std::uint32_t j = static_cast<std::uint32_t>(r * width + c);
+            if ((field.states[j] & OPEN) && field.distances[j] > d) {
+                field.distances[j] = d;
+                heap_.emplace_back(d, j);
+                std::push_heap(heap_.begin(), heap_.end(),
+                    std::greater<Entry>());
+            }
+        }
+    }
+}
@@ -1,8 +1,9 @@
 #include <array>
+#include <utility>
 #include "player.h"
 
 struct Player::PlayerImpl {
-    PlayerImpl();
+    explicit PlayerImpl(Entities* entities);
     ~PlayerImpl()=default;
 
     int                facingX_;
@@ -10,106 +11,126 @@ struct Player::PlayerImpl {
     bool               keepFighting_;
     bool               keepMoving_;
     bool               pickup_;
-    std::array<ITEMPTR, 4> carried_;
-    std::array<ITEMPTR, 2>  wielded_;
-} Player::impl_;
+    Entities*          entities_;
+    std::array<Entity, 4> carried_;
+    std::array<Entity, 2> wielded_;
+};
+
+Player::Player(Entities& entities) : Combat(10, 0, 0),
+impl_ { new Player::PlayerImpl(&entities) } {
+}
+
+Player::~Player() {
 
-Player::Player() : Combat(10, 0, 0) {
 }
 
 int Player::facingX() const {
-    return impl_.facingX_;
+    return impl_->facingX_;
 }
 
 void Player::setFacingX(int  x) {
-    impl_.facingX_ = x;
+    impl_->facingX_ = x;
 }
 
 int Player::facingY() const {
-    return impl_.facingY_;
+    return impl_->facingY_;
 }
 
 void Player::setFacingY(int  y) {
-    impl_.facingY_ = y;
+    impl_->facingY_ = y;
 }
 
 bool Player::keepFighting() const {
-    return impl_.keepFighting_;
+    return impl_->keepFighting_;
 }
 
 void Player::setKeepFighting(bool fight) {
-    impl_.keepFighting_ = fight;
+    impl_->keepFighting_ = fight;
 }
 
 bool Player::keepMoving() const {
-    return impl_.keepMoving_;
+    return impl_->keepMoving_;
 }
 
 void Player::setKeepMoving(bool move) {
-    impl_.keepMoving_ = move;
+    impl_->keepMoving_ = move;
 }
 
 bool Player::pickup() const {
-    return impl_.pickup_;
+    return impl_->pickup_;
 }
 
 void Player::setPickup(bool pickup) {
-    impl_.pickup_ = pickup;
+    impl_->pickup_ = pickup;
 }
 
-bool Player::carry(Item *item) {
-    for (auto & carried : impl_.carried_) {
-        if (carried == nullptr) {
-            carried.reset(item);
+bool Player::carry(Item item) {
+    for (auto & carried : impl_->carried_) {
+        if (carried == NO_ENTITY) {
+            carried = item.entity();
             return true;
         }
     }
     return false;
 }
 
-bool Player::wield(Item *item) {
-    for (auto & wielded: impl_.wielded_) {
-        if (wielded == nullptr) {
-            wielded.reset(item);
+bool Player::wield(Item item) {
+    for (auto & wielded: impl_->wielded_) {
+        if (wielded == NO_ENTITY) {
+            wielded = item.entity();
             return true;
         }
     }
     return false;
 }
 
-Item* Player::drop(int dropped) {
+Item Player::drop(int dropped) {
+    Entity* slot;
     switch(dropped) {
     case 1:
-        return impl_.wielded_[0].release();
     case 2:
-        return impl_.wielded_[1].release();
+        slot = &impl_->wielded_[dropped - 1];
+        break;
     case 3:
-        return impl_.carried_[0].release();
     case 4:
-        return impl_.carried_[1].release();
     case 5:
-        return impl_.carried_[2].release();
     case 6:
-        return impl_.carried_[3].release();
+        slot = &impl_->carried_[dropped - 3];
+        break;
     default:
-        return nullptr;
+        return Item();
     }
+    return Item(impl_->entities_, std::exchange(*slot, NO_ENTITY));
+}
+
+// Takes an item out of the inventory for good, like a potion when it has
+// been drunk.
+bool Player::destroy(Item item) {
+    for (auto & carried : impl_->carried_) {
+        if (carried == item.entity() && carried != NO_ENTITY) {
+            impl_->entities_->destroy(carried);
+            carried = NO_ENTITY;
+            return true;
+        }
+    }
+    return false;
 }
 
-void Player::foreach_carried(std::function<void(std::unique_ptr<Item>&)>
-callback) {
-    for (auto & carried : impl_.carried_) {
-        callback(carried);
+void Player::foreach_carried(std::function<void(Item)> callback) {
+    for (auto & carried : impl_->carried_) {
+        callback(Item(impl_->entities_, carried));
     }
 }
 
-void Player::foreach_wielded(std::function<void(std::unique_ptr<Item>&)>
-callback) {
-    for (auto & wielded : impl_.wielded_) {
-        callback(wielded);
+void Player::foreach_wielded(std::function<void(Item)> callback) {
+    for (auto & wielded : impl_->wielded_) {
+        callback(Item(impl_->entities_, wielded));
     }
 }
 
-Player::PlayerImpl::PlayerImpl() : facingX_{0}, facingY_{0},
-keepFighting_{false}, keepMoving_{false}, pickup_{true}, carried_{}, wielded_{}{
+Player::PlayerImpl::PlayerImpl(Entities* entities) : facingX_{0},
+facingY_{0}, keepFighting_{false}, keepMoving_{false}, pickup_{true},
+entities_{entities}, carried_{}, wielded_{}{
+    carried_.fill(NO_ENTITY);
+    wielded_.fill(NO_ENTITY);
 }
@@ -1,8 +0,0 @@
-#include "potion.h"
-
-Potion::Potion() : Item("a", "healing potion", ITEMTYPE::POTION) {
-}
-
-Potion::~Potion() {
-
-}
@@ -0,0 +1,58 @@
+#include "random.h"
+
+static std::uint64_t rotl(std::uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// Used to expand a single seed into the generator's state.
+static std::uint64_t splitmix64(std::uint64_t& x) {
+    std::uint64_t z = (x += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+Random::Random(std::uint64_t seed) : state_{} {
+    this->seed(seed);
+}
+
+std::uint64_t Random::next() {
+    const std::uint64_t result = rotl(state_[1] * 5, 7) * 9;
+    const std::uint64_t t = state_[1] << 17;
+
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = rotl(state_[3], 45);
+
+    return result;
+}
+
+// A number from 0 to n - 1 without modulo bias (Lemire's method.)
+std::uint32_t Random::uniform(std::uint32_t n) {
+    std::uint64_t m = (next() >> 32) * n;
+    std::uint32_t low = static_cast<std::uint32_t>(m);
+
+    if (low < n) {
+        std::uint32_t threshold = -n % n;
+        while (low < threshold) {
+            m = (next() >> 32) * n;
+            low = static_cast<std::uint32_t>(m);
+        }
+    }
+
+    return m >> 32;
+}
+
+void Random::seed(std::uint64_t seed) {
+    for (auto& s : state_) {
+        s = splitmix64(seed);
+    }
+}
+
+// A new generator whose sequence is independent of this one's.
+Random Random::split() {
+    return Random(next());
+}
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <ctime>
+
+#include "scheduler.h"
+
+constexpr std::uint64_t NANOSECONDS = 1000000000;
+
+static std::uint64_t period(unsigned perSecond) {
+    return NANOSECONDS / std::min(std::max(perSecond, 1u), MAX_RATE);
+}
+
+// Runs func and adds the time it took to timing.
+static void timed(Timing& timing, const std::function<void()>& func) {
+    std::uint64_t start = Scheduler::now();
+    func();
+    std::uint64_t took = Scheduler::now() - start;
+    timing.count++;
+    timing.total += took;
+    timing.worst = std::max(timing.worst, took);
+}
+
+Scheduler::Scheduler(unsigned tickRate, unsigned frameRate, unsigned maxCatchUp)
+: tickPeriod_{period(tickRate)}, framePeriod_{period(frameRate)},
+maxCatchUp_{std::max(maxCatchUp, 1u)}, nextTick_{0}, nextFrame_{0},
+started_{false}, stats_{} {
+}
+
+void Scheduler::setTickRate(unsigned perSecond) {
+    tickPeriod_ = period(perSecond);
+}
+
+void Scheduler::setFrameRate(unsigned perSecond) {
+    framePeriod_ = period(perSecond);
+}
+
+void Scheduler::setMaxCatchUp(unsigned ticks) {
+    maxCatchUp_ = std::max(ticks, 1u);
+}
+
+// The first tick and frame are due straight away.
+void Scheduler::start(std::uint64_t now) {
+    nextTick_ = now;
+    nextFrame_ = now;
+    started_ = true;
+}
+
+// Makes the next frame due now, for when something has changed which
+// shouldn't wait for the frame rate, like the result of a keypress.
+void Scheduler::requestFrame() {
+    nextFrame_ = 0;
+}
+
+// Runs the ticks and the frame which are due by now and returns how many
+// nanoseconds it will be until the next one is.
+std::uint64_t Scheduler::advance(std::uint64_t now,
+const std::function<void()>& tick, const std::function<void()>& frame) {
+    if (!started_) {
+        start(now);
+    }
+
+    unsigned ran = 0;
+    while (nextTick_ <= now && ran < maxCatchUp_) {
+        timed(stats_.ticks, tick);
+        nextTick_ += tickPeriod_;
+        ran++;
+    }
+    if (nextTick_ <= now) {
+        std::uint64_t behind = (now - nextTick_) / tickPeriod_ + 1;
+        stats_.dropped += behind;
+        nextTick_ += behind * tickPeriod_;
+    }
+
+    if (nextFrame_ <= now) {
+        timed(stats_.frames, frame);
+        if (nextFrame_ != 0) {
+            nextFrame_ += framePeriod_;
+        }
+        if (nextFrame_ <= now) {
+            if (nextFrame_ != 0) {
+                stats_.skipped += (now - nextFrame_) / framePeriod_ + 1;
+            }
+            nextFrame_ = now + framePeriod_;
+        }
+    }
+
+    return std::min(nextTick_, nextFrame_) - now;
+}
+
+SchedulerStats Scheduler::stats() const {
+    return stats_;
+}
+
+std::uint64_t Scheduler::now() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * NANOSECONDS + ts.tv_nsec;
+}
@@ -1,65 +1,80 @@
+#include <array>
 #include "tile.h"
+#include "tilestore.h"
 
-struct Tile::TileImpl {
-    TileImpl();
-    ~TileImpl()=default;
-    bool    passable_;
-    bool    seen_;
-    TERRAIN terrain_;
-    bool    visible_;
+// Which kinds of terrain are solid, indexed by TERRAIN.
+static constexpr std::array<bool, static_cast<std::size_t>(TERRAIN::PLAYER) + 1>
+BLOCKS = {
+    false,  // EMPTY
+    false,  // CORRIDOR
+    false,  // H_DOOR_OPEN
+    true,   // H_DOOR_CLOSED
+    false,  // V_DOOR_OPEN
+    true,   // V_DOOR_CLOSED
+    false,  // FLOOR
+    false,  // TRAP
+    true,   // C_WALL
+    true,   // H_WALL
+    true,   // V_WALL
+    true,   // UL_WALL
+    true,   // UR_WALL
+    true,   // LL_WALL
+    true,   // LR_WALL
+    true,   // TT_WALL
+    true,   // RT_WALL
+    true,   // BT_WALL
+    true,   // LT_WALL
+    false,  // PLAYER
 };
 
-Tile::Tile() : impl_ { new Tile::TileImpl() } {
-}
-
-Tile::~Tile() {
-
+Tile::Tile(TileStore& store, std::size_t index) : store_{&store},
+index_{index} {
 }
 
 bool Tile::passable() const {
-    return impl_->passable_;
+    return store_->passable(index_);
 }
 
 void Tile::setPassable(bool passable) {
-     impl_->passable_ = passable;
+    store_->setPassable(index_, passable);
 }
 
 bool Tile::seen() const {
-    return impl_->seen_;
+    return store_->seen(index_);
 }
 
 void Tile::setSeen(bool seen) {
-     impl_->seen_ = seen;
+    store_->setSeen(index_, seen);
 }
 
 TERRAIN Tile::terrain() const {
-    return impl_->terrain_;
+    return store_->terrain(index_);
 }
 
 void Tile::setTerrain(TERRAIN terrain) {
-    impl_->terrain_ = terrain;
+    store_->setTerrain(index_, terrain);
 }
 
 bool Tile::visible() const {
-    return impl_->visible_;
+    return store_->visible(index_);
 }
 
 void Tile::setVisible(bool visible) {
-     impl_->visible_ = visible;
+    store_->setVisible(index_, visible);
 }
 
-bool Tile::isBlock() {
-    return (
-    impl_->terrain_ == TERRAIN::H_WALL  || impl_->terrain_ == TERRAIN::V_WALL ||
-    impl_->terrain_ == TERRAIN::UL_WALL || impl_->terrain_ == TERRAIN::UR_WALL ||
-    impl_->terrain_ == TERRAIN::LR_WALL || impl_->terrain_ == TERRAIN::LL_WALL ||
-    impl_->terrain_ == TERRAIN::TT_WALL || impl_->terrain_ == TERRAIN::RT_WALL ||
-    impl_->terrain_ == TERRAIN::BT_WALL || impl_->terrain_ == TERRAIN::LT_WALL ||
-    impl_->terrain_ == TERRAIN::C_WALL  ||
-    impl_->terrain_ == TERRAIN::H_DOOR_CLOSED || impl_->terrain_ == TERRAIN::V_DOOR_CLOSED);
+bool Tile::door() const {
+    return store_->door(index_);
 }
 
-Tile::TileImpl::TileImpl() : passable_{false}, seen_{false},
-terrain_{TERRAIN::EMPTY}, visible_{false} {
+void Tile::setDoor(bool door) {
+    store_->setDoor(index_, door);
 }
 
+bool Tile::isBlock() const {
+    return isBlock(terrain());
+}
+
+bool Tile::isBlock(TERRAIN terrain) {
+    return BLOCKS[static_cast<std::size_t>(terrain)];
+}
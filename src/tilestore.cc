@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <initializer_list>
+#include "tilestore.h"
+
+TileStore::TileStore() : terrain_{}, passable_{}, seen_{}, visible_{},
+floors_{}, walls_{}, doors_{} {
+}
+
+void TileStore::assign(std::size_t size) {
+    terrain_.assign(size, TERRAIN::EMPTY);
+    passable_.assign(size, false);
+    seen_.assign(size, false);
+    visible_.assign(size, false);
+    floors_.assign(size, false);
+    walls_.assign(size, false);
+    doors_.assign(size, false);
+}
+
+std::size_t TileStore::size() const {
+    return terrain_.size();
+}
+
+bool TileStore::passable(std::size_t i) const {
+    return passable_.test(i);
+}
+
+void TileStore::setPassable(std::size_t i, bool passable) {
+    passable_.set(i, passable);
+}
+
+bool TileStore::seen(std::size_t i) const {
+    return seen_.test(i);
+}
+
+void TileStore::setSeen(std::size_t i, bool seen) {
+    seen_.set(i, seen);
+}
+
+TERRAIN TileStore::terrain(std::size_t i) const {
+    return terrain_[i];
+}
+
+void TileStore::setTerrain(std::size_t i, TERRAIN terrain) {
+    terrain_[i] = terrain;
+    floors_.set(i, terrain == TERRAIN::FLOOR);
+    walls_.set(i, terrain >= TERRAIN::C_WALL && terrain <= TERRAIN::LT_WALL);
+}
+
+bool TileStore::visible(std::size_t i) const {
+    return visible_.test(i);
+}
+
+void TileStore::setVisible(std::size_t i, bool visible) {
+    visible_.set(i, visible);
+}
+
+void TileStore::setAllVisible(bool visible) {
+    visible_.fill(visible);
+}
+
+void TileStore::setVisible(std::size_t first, std::size_t count,
+bool visible) {
+    visible_.fill(first, count, visible);
+}
+
+void TileStore::setSeen(std::size_t first, std::size_t count, bool seen) {
+    seen_.fill(first, count, seen);
+}
+
+bool TileStore::door(std::size_t i) const {
+    return doors_.test(i);
+}
+
+void TileStore::setDoor(std::size_t i, bool door) {
+    doors_.set(i, door);
+}
+
+// Makes count tiles from first empty again.
+void TileStore::clear(std::size_t first, std::size_t count) {
+    std::fill_n(terrain_.begin() + static_cast<std::ptrdiff_t>(first), count,
+        TERRAIN::EMPTY);
+    for (BitLayer* layer : { &passable_, &seen_, &visible_, &floors_, &walls_,
+    &doors_ }) {
+        layer->fill(first, count, false);
+    }
+}
+
+const BitLayer& TileStore::floors() const {
+    return floors_;
+}
+
+const BitLayer& TileStore::walls() const {
+    return walls_;
+}
+
+const BitLayer& TileStore::doors() const {
+    return doors_;
+}
@@ -0,0 +1,24 @@
+#include "varint.h"
+
+void writeVarint(std::ostream& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.put(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+}
+
+bool readVarint(std::istream& in, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = in.get();
+        if (c == std::istream::traits_type::eof()) {
+            return false;
+        }
+        value |= static_cast<std::uint64_t>(c & 0x7f) << shift;
+        if ((c & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
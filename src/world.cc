@@ -1,374 +1,1012 @@
 #include <algorithm>
 #include <array>
-#include <bitset>
+#include <chrono>
 #include <cmath>
-#include <cstdlib>
-#include <map>
+#include <sstream>
 #include <vector>
 #include <utility>
-#include "door.h"
-#include "key.h"
-#include "monster.h"
-#include "potion.h"
-#include "shield.h"
-#include "trap.h"
-#include "weapon.h"
+#include "itemgrid.h"
+#include "mazecarver.h"
+#include "random.h"
+#include "tilestore.h"
+#include "varint.h"
 #include "world.h"
 
-static const int MAP_HEIGHT       = 15;
-static const int MAP_WIDTH        = 15;
+// An endless maze keeps this many rows (a power of two), and builds this
+// many more below the player.  Monsters get harder over ENDLESS_DEPTH rows.
+static constexpr int ENDLESS_ROWS  = 64;
+static constexpr int ENDLESS_AHEAD = 16;
+static constexpr int ENDLESS_DEPTH = 300;
+
+// The eight neighbours of a wall as bits, from the top left (bit 7) to the
+// bottom right (bit 0).  Only the four sides change the shape of a wall.
+static constexpr std::uint8_t UP    = 1 << 6;
+static constexpr std::uint8_t LEFT  = 1 << 4;
+static constexpr std::uint8_t RIGHT = 1 << 3;
+static constexpr std::uint8_t DOWN  = 1 << 1;
+
+// The shape of a wall for each set of neighbours which are walls or doors.
+static constexpr std::array<TERRAIN, 256> wallShapes() {
+    std::array<TERRAIN, 256> shapes{};
+    for (std::size_t neighbours = 0; neighbours < shapes.size(); neighbours++) {
+        TERRAIN shape = TERRAIN::C_WALL;
+        switch (neighbours & (UP | LEFT | RIGHT | DOWN)) {
+            case DOWN:                      shape = TERRAIN::V_WALL;  break;
+            case RIGHT:                     shape = TERRAIN::H_WALL;  break;
+            case RIGHT | DOWN:              shape = TERRAIN::UL_WALL; break;
+            case LEFT:                      shape = TERRAIN::H_WALL;  break;
+            case LEFT | DOWN:               shape = TERRAIN::UR_WALL; break;
+            case LEFT | RIGHT:              shape = TERRAIN::H_WALL;  break;
+            case LEFT | RIGHT | DOWN:       shape = TERRAIN::TT_WALL; break;
+            case UP:                        shape = TERRAIN::V_WALL;  break;
+            case UP | DOWN:                 shape = TERRAIN::V_WALL;  break;
+            case UP | RIGHT:                shape = TERRAIN::LL_WALL; break;
+            case UP | RIGHT | DOWN:         shape = TERRAIN::LT_WALL; break;
+            case UP | LEFT:                 shape = TERRAIN::LR_WALL; break;
+            case UP | LEFT | DOWN:          shape = TERRAIN::RT_WALL; break;
+            case UP | LEFT | RIGHT:         shape = TERRAIN::BT_WALL; break;
+            default:                        break;
+        }
+        shapes[neighbours] = shape;
+    }
+    return shapes;
+}
+
+static constexpr std::array<TERRAIN, 256> WALL_SHAPES = wallShapes();
+
+static bool isWall(TERRAIN terrain) {
+    return terrain >= TERRAIN::C_WALL && terrain <= TERRAIN::LT_WALL;
+}
+
+// Maps of up to SMALL_MAP tiles are handled as one bitboard of four words.
+static constexpr std::size_t SMALL_MAP = 256;
+using SmallBoard = std::array<std::uint64_t, SMALL_MAP / 64>;
+
+static SmallBoard operator|(const SmallBoard& a, const SmallBoard& b) {
+    SmallBoard result;
+    for (std::size_t w = 0; w < result.size(); w++) {
+        result[w] = a[w] | b[w];
+    }
+    return result;
+}
 
-typedef std::unique_ptr<Tile>    TILEPTR;
+static SmallBoard operator&(const SmallBoard& a, const SmallBoard& b) {
+    SmallBoard result;
+    for (std::size_t w = 0; w < result.size(); w++) {
+        result[w] = a[w] & b[w];
+    }
+    return result;
+}
+
+static SmallBoard operator~(const SmallBoard& a) {
+    SmallBoard result;
+    for (std::size_t w = 0; w < result.size(); w++) {
+        result[w] = ~a[w];
+    }
+    return result;
+}
+
+// Moves every bit n (1 to 63) places towards the end of the board.
+static SmallBoard shiftUp(const SmallBoard& a, unsigned n) {
+    SmallBoard result;
+    result[0] = a[0] << n;
+    for (std::size_t w = 1; w < result.size(); w++) {
+        result[w] = a[w] << n | a[w - 1] >> (64 - n);
+    }
+    return result;
+}
+
+// Moves every bit n (1 to 63) places towards the start of the board.
+static SmallBoard shiftDown(const SmallBoard& a, unsigned n) {
+    SmallBoard result;
+    for (std::size_t w = 0; w + 1 < result.size(); w++) {
+        result[w] = a[w] >> n | a[w + 1] << (64 - n);
+    }
+    result[result.size() - 1] = a[result.size() - 1] >> n;
+    return result;
+}
+
+// The neighbours of a tile for which isEdge(row, col) is true.  Neighbours
+// off the map (outside rows top to bottom - 1) don't count.
+template<typename F>
+static std::uint8_t neighbours(int row, int col, int top, int bottom,
+int width, F isEdge) {
+    std::uint8_t edges = 0;
+    for (int y = row - 1; y < row + 2; y++) {
+        for (int x = col - 1; x < col + 2; x++) {
+            if (y == row && x == col) {
+                continue;
+            }
+            edges <<= 1;
+            if (y >= top && y < bottom && x >= 0 && x < width && isEdge(y, x)) {
+                edges |= 1;
+            }
+        }
+    }
+    return edges;
+}
+
+// How to turn the first octant (rows going up from the player, columns to
+// their left) into each of the eight: col += dx * xx + dy * xy and
+// row += dx * yx + dy * yy.
+static constexpr int OCTANTS[8][4] = {
+    {  1,  0,  0,  1 }, {  0,  1,  1,  0 }, {  0, -1,  1,  0 },
+    { -1,  0,  0,  1 }, { -1,  0,  0, -1 }, {  0, -1, -1,  0 },
+    {  0,  1, -1,  0 }, {  1,  0,  0, -1 },
+};
+
+// Mixes two numbers into a well scrambled one (the splitmix64 finalizer.)
+static std::uint64_t mix(std::uint64_t a, std::uint64_t b) {
+    std::uint64_t z = a + 0x9e3779b97f4a7c15 * (b + 1);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
 
 struct World::WorldImpl {
     WorldImpl();
     ~WorldImpl()=default;
+    Entity itemAt(int row, int col);
+    void place(int row, int col, Entity entity);
     void generateMaze();
     void makeFloor(int row, int col);
     void addItem(int row, int col);
-    void addDoors();
+    Entity newItem(int row, int col);
+    void addDoors(int first, int last);
     void addExits();
-    void addWalls();
-    void specializeWalls();
-
-    std::array<std::array<TILEPTR, MAP_WIDTH>,MAP_HEIGHT> map_;
+    void addWalls(int first, int last);
+    void specializeWalls(int first, int last);
+    void autotile(int first, int last, int left, int right);
+    bool isEdge(int row, int col);
+    void descend(int row);
+    void dropRow();
+    std::uint64_t chunkSeed(int chunkRow, int chunkCol) const;
+    void carveChunk(int chunkRow, int chunkCol);
+    void generateChunk(int chunkRow, int chunkCol, TileStore& tiles,
+        ItemGrid& items);
+    bool floorAt(int row, int col) const;
+    int  doorAt(int row, int col) const;
+    int  doorPattern(int row, int col) const;
+
+    void clearLit();
+    void light(int row, int col);
+    bool opaque(int row, int col);
+    void castLight(int distance, double start, double end,
+        const int (&octant)[4]);
+    void resize();
+    void addWallsSmall();
+    std::size_t rowWords() const;
+    int slot(int row) const;
+    std::size_t index(int row, int col) const;
+    Tile at(int row, int col);
+
+    Random                                      rng_;
+    std::array<double, static_cast<std::size_t>(PHASE::COUNT)> phaseSeconds_;
+    int                                         height_;
+    int                                         width_;
+    int                                         depth_;
+    bool                                        endless_;
+    int                                         top_;
+    int                                         bottom_;
+    int                                         walled_;
+    int                                         doored_;
+    TileStore                                   tiles_;
+    int                                         litTop_;
+    int                                         litLeft_;
+    int                                         litBottom_;
+    int                                         litRight_;
+    bool                                        allLit_;
+    int                                         fovRadius_;
+    int                                         fovRow_;
+    int                                         fovCol_;
+    bool                                        fovValid_;
     int                                         playerRow_;
     int                                         playerCol_;
     int                                         startCol_;
     int                                         endCol_;
-    std::map<std::pair<int, int>, ITEMPTR>      items_;
-} World::impl_;
+    Entities                                    entities_;
+    ItemGrid                                    items_;
+    MAZE                                        maze_;
+    MazeCarver                                  carver_;
+    bool                                        chunked_;
+    std::uint64_t                               seed_;
+    ChunkStore                                  chunks_;
+    std::vector<std::uint8_t>                   floors_;
+    int                                         floorsTop_;
+    int                                         floorsLeft_;
+    std::vector<std::uint64_t>                  edges_;
+    std::vector<std::uint64_t>                  rows_;
+};
+
+World::World() : impl_ { new World::WorldImpl() } {
+}
+
+World::~World() {
+
+}
+
+void World::create(int height, int width, std::uint64_t seed, MAZE maze) {
+    impl_->rng_.seed(seed);
+    impl_->maze_ = maze;
+
+    // The maze needs odd dimensions so it is surrounded by walls.
+    impl_->height_ = std::clamp(height | 1, MIN_MAP_SIZE, MAX_MAP_SIZE);
+    impl_->width_ = std::clamp(width | 1, MIN_MAP_SIZE, MAX_MAP_SIZE);
+    impl_->depth_ = impl_->height_;
+    impl_->endless_ = false;
+    impl_->chunked_ = false;
+    impl_->chunks_.clear();
+    impl_->entities_.clear();
+    impl_->top_ = 0;
+    impl_->bottom_ = impl_->height_;
 
-void World::create() {
     // Begin by filling in the entire grid.
-    for (auto & row : impl_.map_) {
-        for (auto & col : row) {
-            col = TILEPTR(new Tile());
-        }
-    }
+    impl_->tiles_.assign(static_cast<std::size_t>(impl_->height_) *
+        impl_->width_);
+    impl_->clearLit();
+    impl_->items_.assign(impl_->height_, impl_->width_);
+    impl_->resize();
+
+    auto timed = [this](PHASE phase, std::function<void()> step) {
+        auto start = std::chrono::steady_clock::now();
+        step();
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        impl_->phaseSeconds_[static_cast<std::size_t>(phase)] = elapsed.count();
+    };
 
     // Build the maze (including items, monsters and traps,)
-    impl_.generateMaze();
+    timed(PHASE::GENERATE_MAZE, [this]() { impl_->generateMaze(); });
 
     // Add exits and set the player position.
-    impl_.addExits();
+    timed(PHASE::ADD_EXITS, [this]() { impl_->addExits(); });
 
     // Add basic walls
-    impl_.addWalls();
+    timed(PHASE::ADD_WALLS, [this]() {
+        impl_->addWalls(0, impl_->height_);
+    });
 
     // Doors have to be placed separately after walls.
-    impl_.addDoors();
+    timed(PHASE::ADD_DOORS, [this]() {
+        impl_->addDoors(1, impl_->height_ - 1);
+    });
 
     // Make walls fancier.
-    impl_.specializeWalls();
+    timed(PHASE::SPECIALIZE_WALLS, [this]() {
+        impl_->specializeWalls(0, impl_->height_);
+    });
+}
+
+// An endless maze is built with Eller's algorithm a couple of rows at a
+// time as the player goes south.  Only the last ENDLESS_ROWS rows are kept,
+// in a ring, so memory use doesn't grow with depth.  It has an entrance but
+// no exit or dragon.
+void World::createEndless(int width, std::uint64_t seed) {
+    impl_->rng_.seed(seed);
+    impl_->maze_ = MAZE::ELLER;
+
+    impl_->width_ = std::clamp(width | 1, MIN_MAP_SIZE, MAX_MAP_SIZE);
+    impl_->depth_ = ENDLESS_DEPTH;
+    impl_->endless_ = true;
+    impl_->chunked_ = false;
+    impl_->chunks_.clear();
+    impl_->entities_.clear();
+    impl_->top_ = 0;
+    impl_->bottom_ = 1;
+    impl_->height_ = 0;
+    impl_->walled_ = 0;
+    impl_->doored_ = 1;
+    impl_->startCol_ = -1;
+    impl_->endCol_ = -1;
+
+    impl_->tiles_.assign(static_cast<std::size_t>(ENDLESS_ROWS) *
+        impl_->width_);
+    impl_->clearLit();
+    impl_->items_.assign(ENDLESS_ROWS, impl_->width_);
+    impl_->resize();
+    impl_->phaseSeconds_.fill(0);
+    impl_->carver_.startRows(impl_->width_);
+
+    impl_->playerRow_ = 0;
+    impl_->descend(0);
+    impl_->playerCol_ = impl_->startCol_;
+}
+
+// A chunked maze is generated CHUNKSIZE x CHUNKSIZE tiles at a time when
+// they are first needed, from the seed and the position of the chunk, and
+// only about budget bytes of it are kept in memory.  Each chunk has its own
+// maze, joined to the one above or to the left of it by one passage, so the
+// whole is still a perfect maze.  Doors are decided per tile by a hash, so
+// the chunks around one can tell where its doors are without generating it.
+void World::createChunked(int height, int width, std::uint64_t seed,
+MAZE maze, std::size_t budget) {
+    impl_->rng_.seed(seed);
+    impl_->maze_ = maze;
+    impl_->seed_ = seed;
+
+    impl_->height_ = std::clamp(height | 1, MIN_MAP_SIZE, MAX_MAP_SIZE);
+    impl_->width_ = std::clamp(width | 1, MIN_MAP_SIZE, MAX_MAP_SIZE);
+    impl_->depth_ = impl_->height_;
+    impl_->endless_ = false;
+    impl_->chunked_ = true;
+    impl_->top_ = 0;
+    impl_->bottom_ = impl_->height_;
+
+    impl_->tiles_.assign(0);
+    impl_->chunks_.clear();
+    impl_->entities_.clear();
+    impl_->items_.assign(0, 0);
+    impl_->clearLit();
+    impl_->phaseSeconds_.fill(0);
+    impl_->floors_.assign(static_cast<std::size_t>(9) * CHUNKSIZE * CHUNKSIZE,
+        0);
+    impl_->resize();
+
+    std::uint32_t cells = static_cast<std::uint32_t>((impl_->width_ - 1) / 2);
+    impl_->startCol_ = 1 + 2 * static_cast<int>(impl_->rng_.uniform(cells));
+    impl_->endCol_ = 1 + 2 * static_cast<int>(impl_->rng_.uniform(cells));
+    impl_->playerRow_ = 0;
+    impl_->playerCol_ = impl_->startCol_;
+
+    impl_->chunks_.assign(impl_->height_, impl_->width_, budget,
+    impl_->entities_, [this](int chunkRow, int chunkCol, TileStore& tiles, ItemGrid& items) {
+        impl_->generateChunk(chunkRow, chunkCol, tiles, items);
+    });
+}
+
+void World::autotile(int top, int left, int height, int width) {
+    int first = std::max(top, impl_->top_);
+    int last = std::min(top + height, impl_->height_);
+    int right = std::min(left + width, impl_->width_);
+    left = std::max(left, 0);
+    if (first < last && left < right) {
+        impl_->autotile(first, last, left, right);
+    }
+}
+
+ChunkStats World::chunkStats() const {
+    return impl_->chunks_.stats();
+}
+
+double World::phaseSeconds(PHASE phase) const {
+    return impl_->phaseSeconds_[static_cast<std::size_t>(phase)];
 }
 
 int World::height() const {
-    return MAP_HEIGHT;
+    return impl_->height_;
 }
 
 int World::width() const {
-    return MAP_WIDTH;
+    return impl_->width_;
 }
 
 int World::playerRow() const {
-    return impl_.playerRow_;
+    return impl_->playerRow_;
 }
 
 void World::setPlayerRow(int row) {
-    impl_.playerRow_ = row;
+    impl_->playerRow_ = row;
+    if (impl_->endless_) {
+        impl_->descend(row);
+    }
 }
 
 int World::playerCol() const {
-    return impl_.playerCol_;
+    return impl_->playerCol_;
 }
 
 void World::setPlayerCol(int col) {
-    impl_.playerCol_ = col;
+    impl_->playerCol_ = col;
 }
 
 int World::startCol() const {
-    return impl_.startCol_;
+    return impl_->startCol_;
 }
 
-void  World::foreach_item(int top, int left, int height, int width,
-    std::function<void(int, int, ITEMPTR&)> callback) {
-    for(auto & i : impl_.items_) {
-        int row = i.first.first;
-        int col = i.first.second;
-        if (row < top || row > top + height - 1 || col < left ||
-        col > left + width - 1) {
-            continue;
-        }
-        callback(row, col, i.second);
+int World::endCol() const {
+    return impl_->endCol_;
+}
+
+bool World::endless() const {
+    return impl_->endless_;
+}
+
+bool World::chunked() const {
+    return impl_->chunked_;
+}
+
+int World::firstRow() const {
+    return impl_->top_;
+}
+
+// The top of an endless maze is forgotten, so go back to the highest row
+// that is still there instead.
+void World::returnToStart() {
+    if (impl_->endless_) {
+        impl_->playerRow_ = impl_->top_ | 1;
+        impl_->playerCol_ = 1;
+    } else {
+        impl_->playerRow_ = 0;
+        impl_->playerCol_ = impl_->startCol_;
     }
 }
 
-Item* World::itemAt(int row, int col) const {
-    auto item = impl_.items_.find(std::make_pair(row, col));
-    if (item == impl_.items_.end()) {
-        return nullptr;
+Entities& World::entities() {
+    return impl_->entities_;
+}
+
+void  World::foreach_item(int top, int left, int height, int width,
+    std::function<void(int, int, Item)> callback) {
+    Entities* entities = &impl_->entities_;
+    auto visit = [&](int row, int col, Entity item) {
+        callback(row, col, Item(entities, item));
+    };
+    if (impl_->chunked_) {
+        impl_->chunks_.foreach(top, left, height, width, visit);
+        return;
+    }
+    if (!impl_->endless_) {
+        impl_->items_.foreach(top, left, height, width, visit);
+        return;
     }
 
-    return item->second.get();
+    // The rows of an endless maze may wrap around the ring.
+    int first = std::max(top, impl_->top_);
+    int last = std::min(top + height, impl_->bottom_);
+    for (int row = first; row < last; row++) {
+        impl_->items_.foreach(impl_->slot(row), left, 1, width,
+            [&](int, int col, Entity item) { visit(row, col, item); });
+    }
 }
 
-void World::insertItem(int row, int col, Item* item) {
-    impl_.items_[std::make_pair(row, col)] = ITEMPTR(item);
+Item World::itemAt(int row, int col) const {
+    return Item(&impl_->entities_, impl_->itemAt(row, col));
 }
 
+void World::insertItem(int row, int col, Item item) {
+    Tile t = impl_->at(row, col);
+    if (t.door() || item.type() == ITEMTYPE::DOOR) {
+        impl_->fovValid_ = false;
+    }
+    t.setDoor(item.type() == ITEMTYPE::DOOR);
+    impl_->place(row, col, item.entity());
+}
+
+// Takes the item off the map.  Unless it is destroyed it lives on without a
+// position, for the player to carry.
 bool World::removeItem(int row, int col, bool destroy) {
-    auto item = impl_.items_.find(std::make_pair(row, col));
+    Entity item = impl_->chunked_ ? impl_->chunks_.remove(row, col) :
+        impl_->items_.remove(impl_->slot(row), col);
+    Tile t = impl_->at(row, col);
+    if (t.door()) {
+        t.setDoor(false);
+        impl_->fovValid_ = false;
+    }
 
-    if (item == impl_.items_.end()) {
+    if (item == NO_ENTITY) {
         return false;
     }
 
     if (destroy) {
-        delete item->second.release();
+        impl_->entities_.destroy(item);
     } else {
-        item->second.release();
+        impl_->entities_.positions().erase(item);
     }
-    impl_.items_.erase(item);
 
     return true;
 }
 
+// Moves a monster to an empty place.  Doors and traps stay put.
+bool World::moveItem(int row, int col, int toRow, int toCol) {
+    Entity item = impl_->chunked_ ? impl_->chunks_.remove(row, col) :
+        impl_->items_.remove(impl_->slot(row), col);
+    if (item == NO_ENTITY) {
+        return false;
+    }
+    impl_->place(toRow, toCol, item);
+    return true;
+}
+
+// Something about the item at row, col has been changed in place, like a
+// door being opened or a trap sprung.  In a chunked maze its chunk has to
+// be written out again when it is evicted or the change is lost.
+void World::modified(int row, int col) {
+    if (impl_->chunked_) {
+        impl_->chunks_.touch(row, col);
+    }
+}
+
 void World::setAllVisible(bool visibility) {
-    for (auto & row : impl_.map_) {
-        for (auto & col : row) {
-            col->setVisible(visibility);
-        }
+    if (impl_->chunked_) {
+        impl_->chunks_.setAllVisible(visibility);
+    } else {
+        impl_->tiles_.setAllVisible(visibility);
     }
+    impl_->clearLit();
+    impl_->allLit_ = visibility;
 }
 
+// Field of view is only worked out again when the player has moved or
+// something which blocks the view has changed since the last time.
 void World::fov() {
-    setAllVisible(false);
+    if (impl_->fovValid_ && impl_->fovRow_ == impl_->playerRow_ &&
+    impl_->fovCol_ == impl_->playerCol_) {
+        return;
+    }
 
-    for (int i = impl_.playerRow_ - 1; i < impl_.playerRow_ + 2; i++) {
-        if (i < 0 || i >= MAP_HEIGHT) {
-            continue;
-        }
-        for (int j = impl_.playerCol_ - 1; j < impl_.playerCol_ + 2; j++) {
-            if (j < 0 || j >= MAP_WIDTH) {
-                continue;
+    // Only the tiles lit last time need to be darkened, not the whole map.
+    if (impl_->allLit_) {
+        setAllVisible(false);
+    }
+    for (int row = std::max(impl_->litTop_, impl_->top_);
+    row < impl_->litBottom_; row++) {
+        if (impl_->chunked_) {
+            for (int col = impl_->litLeft_; col < impl_->litRight_; col++) {
+                impl_->at(row, col).setVisible(false);
             }
-            impl_.map_[i][j]->setVisible(true);
-            impl_.map_[i][j]->setSeen(true);
+        } else {
+            impl_->tiles_.setVisible(impl_->index(row, impl_->litLeft_),
+                static_cast<std::size_t>(impl_->litRight_ - impl_->litLeft_),
+                false);
         }
     }
+
+    int radius = impl_->fovRadius_;
+    impl_->litTop_ = std::max(impl_->playerRow_ - radius, impl_->top_);
+    impl_->litBottom_ = std::min(impl_->playerRow_ + radius + 1,
+        impl_->height_);
+    impl_->litLeft_ = std::max(impl_->playerCol_ - radius, 0);
+    impl_->litRight_ = std::min(impl_->playerCol_ + radius + 1,
+        impl_->width_);
+
+    impl_->light(impl_->playerRow_, impl_->playerCol_);
+    for (auto& octant : OCTANTS) {
+        impl_->castLight(1, 1.0, 0.0, octant);
+    }
+
+    impl_->fovRow_ = impl_->playerRow_;
+    impl_->fovCol_ = impl_->playerCol_;
+    impl_->fovValid_ = true;
+}
+
+int World::fovRadius() const {
+    return impl_->fovRadius_;
 }
 
-Tile* World::tileAt(int row, int col) const {
-    return impl_.map_[row][col].get();
+void World::setFovRadius(int radius) {
+    impl_->fovRadius_ = std::clamp(radius, 1, MAX_FOV_RADIUS);
+    impl_->fovValid_ = false;
+}
+
+void World::invalidateFov() {
+    impl_->fovValid_ = false;
+}
+
+Tile World::tileAt(int row, int col) const {
+    return impl_->at(row, col);
+}
+
+// A level is written as unsigned LEB128 varints and bytes:
+//   height width startCol endCol
+//   runs (terrain-byte length)...        run-length encoded terrain
+//   items (index-delta type-byte [payload])...
+// where the payload is the horizontal/open flags of a door, whether a trap
+// is sprung, the health of a monster or the bonuses of an armament.
+void World::write(std::ostream& out) const {
+    writeVarint(out, impl_->height_);
+    writeVarint(out, impl_->width_);
+    writeVarint(out, impl_->startCol_);
+    writeVarint(out, impl_->endCol_);
+
+    std::vector<std::pair<TERRAIN, std::size_t>> runs;
+    for (int row = 0; row < impl_->height_; row++) {
+        for (int col = 0; col < impl_->width_; col++) {
+            TERRAIN terrain = impl_->at(row, col).terrain();
+            if (runs.empty() || runs.back().first != terrain) {
+                runs.emplace_back(terrain, 0);
+            }
+            runs.back().second++;
+        }
+    }
+    writeVarint(out, runs.size());
+    for (auto& run : runs) {
+        out.put(static_cast<char>(run.first));
+        writeVarint(out, run.second);
+    }
+
+    // Chunked mazes give items in order a row at a time.
+    std::ostringstream items;
+    std::size_t count = 0;
+    std::size_t last = 0;
+    const Entities& entities = impl_->entities_;
+    auto writeItem = [&](int row, int col, Entity item) {
+        std::size_t i = static_cast<std::size_t>(row) * impl_->width_ + col;
+        writeVarint(items, i - last);
+        last = i;
+        count++;
+        items.put(static_cast<char>(archetype(entities.archetype(item)).type));
+
+        if (const DoorState* door = entities.doors().find(item)) {
+            items.put(static_cast<char>(door->horizontal | door->open << 1));
+        } else if (const TrapState* trap = entities.traps().find(item)) {
+            items.put(static_cast<char>(trap->sprung));
+        } else if (const Combat* combat = entities.combat().find(item)) {
+            writeVarint(items, static_cast<std::uint64_t>(combat->health()));
+        } else if (const Armament* armament = entities.armaments().find(item)) {
+            writeVarint(items, static_cast<std::uint64_t>(armament->offenseBonus()));
+            writeVarint(items, static_cast<std::uint64_t>(armament->defenseBonus()));
+        }
+    };
+    if (impl_->chunked_) {
+        for (int row = 0; row < impl_->height_; row++) {
+            impl_->chunks_.foreach(row, 0, 1, impl_->width_, writeItem);
+        }
+    } else {
+        impl_->items_.foreach(0, 0, impl_->height_, impl_->width_, writeItem);
+    }
+
+    writeVarint(out, count);
+    out << items.str();
 }
 
 // private methods
 
-World::WorldImpl::WorldImpl() : map_{}, playerRow_{0}, playerCol_{0},
-startCol_{0}, endCol_{0}, items_{} {
+World::WorldImpl::WorldImpl() : rng_{}, phaseSeconds_{},
+height_{0}, width_{0}, depth_{0}, endless_{false}, top_{0}, bottom_{0},
+walled_{0}, doored_{0}, tiles_{}, litTop_{0}, litLeft_{0},
+litBottom_{0}, litRight_{0}, allLit_{false},
+fovRadius_{DEFAULT_FOV_RADIUS}, fovRow_{0}, fovCol_{0}, fovValid_{false}, playerRow_{0},
+playerCol_{0}, startCol_{0}, endCol_{0}, entities_{}, items_{}, maze_{DEFAULT_MAZE}, carver_{}, chunked_{false},
+seed_{0}, chunks_{}, floors_{}, floorsTop_{0}, floorsLeft_{0},
+edges_{}, rows_{} {
 }
 
-void World::WorldImpl::generateMaze() {
-    // Build maze (Algorithm based on VB/JS examples at
-    // http://www.roguebasin.com/index.php?title=Simple_maze)
-    int done = 0;
-    std::vector<std::pair<int, int>> dirs;
-    dirs.push_back(std::make_pair(-1,0));
-    dirs.push_back(std::make_pair(1,0));
-    dirs.push_back(std::make_pair(0,-1));
-    dirs.push_back(std::make_pair(0,1));
-
-    do {
-        // this code is used to make sure the numbers are odd
-        int row = 1 + rand() % ((MAP_HEIGHT - 1) / 2) * 2;
-        int col = 1 + rand() % ((MAP_WIDTH - 1) / 2) * 2;
-
-        // Start tile.
-        if (done == 0) {
-            makeFloor(row, col);
+// Forgets which tiles were lit, so the next fov() starts afresh.
+void World::WorldImpl::clearLit() {
+    litTop_ = litLeft_ = litBottom_ = litRight_ = 0;
+    allLit_ = false;
+    fovValid_ = false;
+}
+
+void World::WorldImpl::light(int row, int col) {
+    if (chunked_) {
+        Tile t = at(row, col);
+        t.setVisible(true);
+        if (!t.seen()) {
+            t.setSeen(true);
+            chunks_.touch(row, col);
+        }
+        return;
+    }
+    std::size_t i = index(row, col);
+    tiles_.setVisible(i, true);
+    tiles_.setSeen(i, true);
+}
+
+// Walls and closed doors block the view.
+bool World::WorldImpl::opaque(int row, int col) {
+    if (!chunked_) {
+        std::size_t i = index(row, col);
+        if (tiles_.walls().test(i)) {
+            return true;
         }
+        if (!tiles_.doors().test(i)) {
+            return false;
+        }
+    } else {
+        Tile t = at(row, col);
+        if (t.isBlock()) {
+            return true;
+        }
+        if (!t.door()) {
+            return false;
+        }
+    }
+    const DoorState* door = entities_.doors().find(itemAt(row, col));
+    return door != nullptr && !door->open;
+}
 
-        if (impl_.map_[row][col]->terrain() == TERRAIN::FLOOR) {
-            //Randomize Directions
-            std::random_shuffle(dirs.begin(), dirs.end());
+// Recursive shadowcasting.  The octant is scanned a row at a time outwards
+// from the player, keeping the range of slopes from start down to end which
+// can still be seen.  A run of opaque tiles splits the range: the part
+// before it is scanned further out by a recursive call, and the scan goes
+// on with the part after it.
+void World::WorldImpl::castLight(int distance, double start, double end,
+const int (&octant)[4]) {
+    if (start < end) {
+        return;
+    }
 
-            bool blocked = true;
+    int radius = fovRadius_;
+    double nextStart = start;
+    for (int dy = -distance; dy >= -radius; dy--) {
+        bool blocked = false;
+        for (int dx = dy; dx <= 0; dx++) {
+            double left = (dx - 0.5) / (dy + 0.5);
+            double right = (dx + 0.5) / (dy - 0.5);
+            if (start < right) {
+                continue;
+            } else if (end > left) {
+                break;
+            }
 
-            do {
-                if (rand() % 5 == 0) {
-                    std::random_shuffle(dirs.begin(), dirs.end());
-                }
+            int col = playerCol_ + dx * octant[0] + dy * octant[1];
+            int row = playerRow_ + dx * octant[2] + dy * octant[3];
+            bool inMap = row >= litTop_ && row < litBottom_ && col >= 0 &&
+                col < width_;
+            if (inMap && dx * dx + dy * dy <= radius * radius) {
+                light(row, col);
+            }
 
-                blocked = true;
-                for (int i = 0; i < 4; i++) {
-                    // Determine which direction the tile is
-                    int r = row + dirs[i].first * 2;
-                    int c = col + dirs[i].second * 2;
-                    //Check to see if the tile can be used
-                    if (r >= 1 && r < MAP_HEIGHT - 1 && c >= 1 && c < MAP_WIDTH - 1) {
-                        if (impl_.map_[r][c]->terrain() != TERRAIN::FLOOR) {
-                            //create destination location
-                            makeFloor(r, c);
-                            //create intermediate location
-                            makeFloor(row + dirs[i].first, col + dirs[i].second);
-                            row = r;
-                            col = c;
-                            blocked = false;
-                            done++;
-                            break;
-                        }
-                    }
+            bool wall = !inMap || opaque(row, col);
+            if (blocked) {
+                if (wall) {
+                    nextStart = right;
+                    continue;
                 }
-                //recursive, no directions found, loop back a node
-            } while (!blocked);
+                blocked = false;
+                start = nextStart;
+            } else if (wall && -dy < radius) {
+                blocked = true;
+                castLight(-dy + 1, start, left, octant);
+                nextStart = right;
+            }
         }
-    } while (done + 1 < ((MAP_HEIGHT - 1) * (MAP_WIDTH - 1)) / 4);
+        if (blocked) {
+            break;
+        }
+    }
+}
+
+// Sizes the scratch rows for the width of the map, so generating it doesn't
+// allocate.
+void World::WorldImpl::resize() {
+    edges_.assign(3 * rowWords(), 0);
+    rows_.assign(7 * rowWords(), 0);
+}
+
+// A row of the map as bits, with at least one clear bit after the last tile.
+std::size_t World::WorldImpl::rowWords() const {
+    return static_cast<std::size_t>(width_) / 64 + 1;
+}
+
+// Where a row is kept.  An endless maze reuses the rows it has left behind.
+int World::WorldImpl::slot(int row) const {
+    return endless_ ? row & (ENDLESS_ROWS - 1) : row;
+}
+
+std::size_t World::WorldImpl::index(int row, int col) const {
+    return static_cast<std::size_t>(slot(row)) * width_ + col;
 }
 
+Tile World::WorldImpl::at(int row, int col) {
+    if (chunked_) {
+        return chunks_.tileAt(row, col);
+    }
+    return Tile(tiles_, index(row, col));
+}
+
+Entity World::WorldImpl::itemAt(int row, int col) {
+    if (chunked_) {
+        return chunks_.itemAt(row, col);
+    }
+    return items_.at(slot(row), col);
+}
+
+// Puts an entity on the map, destroying whatever was there before.
+void World::WorldImpl::place(int row, int col, Entity entity) {
+    entities_.positions().insert(entity, Position{row, col});
+    entities_.destroy(chunked_ ? chunks_.insert(row, col, entity) :
+        items_.insert(slot(row), col, entity));
+}
+
+void World::WorldImpl::generateMaze() {
+    carver_.carve(maze_, height_, width_, rng_,
+        [this](int row, int col) { makeFloor(row, col); });
+}
+
+// Build an endless maze until there are ENDLESS_AHEAD finished rows below
+// the given one.  Each row of cells adds two rows of tiles, and each later
+// step needs the rows either side of the ones it works on to be done with
+// the step before, so walls, doors and wall shapes trail behind.
+void World::WorldImpl::descend(int row) {
+    while (height_ <= row + ENDLESS_AHEAD) {
+        auto start = std::chrono::steady_clock::now();
+        auto lap = [&](PHASE phase) {
+            auto now = std::chrono::steady_clock::now();
+            std::chrono::duration<double> elapsed = now - start;
+            phaseSeconds_[static_cast<std::size_t>(phase)] += elapsed.count();
+            start = now;
+        };
+
+        while (bottom_ + 2 - top_ > ENDLESS_ROWS) {
+            dropRow();
+        }
+        carver_.carveRow(rng_,
+            [this](int row, int col) { makeFloor(row, col); });
+        bottom_ += 2;
+        lap(PHASE::GENERATE_MAZE);
+
+        if (startCol_ == -1) {
+            startCol_ = 1 + 2 * static_cast<int>(rng_.uniform(
+                static_cast<std::uint32_t>((width_ - 1) / 2)));
+            makeFloor(0, startCol_);
+            lap(PHASE::ADD_EXITS);
+        }
+
+        addWalls(walled_, bottom_ - 1);
+        walled_ = bottom_ - 1;
+        lap(PHASE::ADD_WALLS);
+
+        addDoors(doored_, walled_ - 1);
+        doored_ = walled_ - 1;
+        lap(PHASE::ADD_DOORS);
+
+        specializeWalls(height_, doored_ - 1);
+        height_ = doored_ - 1;
+        lap(PHASE::SPECIALIZE_WALLS);
+    }
+}
+
+// Forget the top row of an endless maze to make room for another.
+void World::WorldImpl::dropRow() {
+    tiles_.clear(index(top_, 0), static_cast<std::size_t>(width_));
+    for (int col = 0; col < width_; col++) {
+        entities_.destroy(items_.remove(slot(top_), col));
+    }
+    top_++;
+}
 
 void World::WorldImpl::makeFloor(int row, int col) {
-    impl_.map_[row][col]->setTerrain(TERRAIN::FLOOR);
-    impl_.map_[row][col]->setPassable(true);
+    at(row, col).setTerrain(TERRAIN::FLOOR);
+    at(row, col).setPassable(true);
     addItem(row, col);
 }
 
 void World::WorldImpl::addItem(int row, int col) {
+    Entity item = newItem(row, col);
+    if (item != NO_ENTITY) {
+        place(row, col, item);
+    }
+}
+
+Entity World::WorldImpl::newItem(int row, int col) {
 
     // Start space always empty
     if (row == 0 && col == startCol_) {
-        return;
+        return NO_ENTITY;
     // End space always dragon
-    } else if (row == MAP_HEIGHT - 1 && col == endCol_) {
-        Monster* dragon = new Monster("the", "dragon", ITEMTYPE::DRAGON, 1, 6, 6);
-        items_[std::make_pair(row, col)] = ITEMPTR(dragon);
+    } else if (row == height_ - 1 && col == endCol_) {
+        return entities_.create(ARCHETYPE::DRAGON);
     } else {
-        int r = rand() % 100;
+        int r = rng_.uniform(100);
 
         // empty
         if (r < 50) {
-            return;
+            return NO_ENTITY;
 
         // monster
         } else if (r < 75) {
-            Monster* monster;
-            int rr = rand() % 10;
-            if (row < MAP_HEIGHT / 3) {
+            ARCHETYPE monster;
+            int rr = rng_.uniform(10);
+            if (row < depth_ / 3) {
                 if (rr < 4) {
-                    monster = new Monster("a", "vampire bat", ITEMTYPE::BAT, 1, 0, 2);
+                    monster = ARCHETYPE::VAMPIRE_BAT;
                 } else if (rr < 8) {
-                    monster = new Monster("a", "giant rat", ITEMTYPE::RAT, 1, 1, 1);
+                    monster = ARCHETYPE::GIANT_RAT;
                 } else if (rr < 9) {
-                    monster = new Monster("a", "zombie", ITEMTYPE::ZOMBIE, 1, 1, 1);
+                    monster = ARCHETYPE::ZOMBIE;
                 } else {
-                    monster = new Monster("a", "kobold", ITEMTYPE::KOBOLD, 1, 1, 2);
+                    monster = ARCHETYPE::KOBOLD;
                 }
-            } else if (row < MAP_HEIGHT * 2 / 3) {
+            } else if (row < depth_ * 2 / 3) {
                 if (rr < 4) {
-                    monster = new Monster("a", "hobgoblin", ITEMTYPE::HOBGOBLIN, 1, 1, 2);
+                    monster = ARCHETYPE::HOBGOBLIN;
                 } else if (rr < 8) {
-                    monster = new Monster("an", "orc", ITEMTYPE::ORC, 1, 2, 2);
+                    monster = ARCHETYPE::ORC;
                 } else if (rr < 9) {
-                    monster = new Monster("a", "giant spider", ITEMTYPE::SPIDER, 1, 3, 2);
+                    monster = ARCHETYPE::GIANT_SPIDER;
                 } else {
-                    monster = new Monster("a", "gelatinous cube", ITEMTYPE::CUBE, 1, 1, 5);
+                    monster = ARCHETYPE::GELATINOUS_CUBE;
                 }
             } else {
                 if (rr < 2) {
-                    monster = new Monster("a", "lizard man", ITEMTYPE::LIZARDMAN, 1, 2, 4);
+                    monster = ARCHETYPE::LIZARD_MAN;
                 } else if (rr < 4) {
-                    monster = new Monster("a", "naga", ITEMTYPE::NAGA, 1, 3, 3);
+                    monster = ARCHETYPE::NAGA;
                 } else if (rr < 6) {
-                    monster = new Monster("a", "troll", ITEMTYPE::TROLL, 1, 4, 2);
+                    monster = ARCHETYPE::TROLL;
                 } else if (rr < 8) {
-                    monster = new Monster("a", "minotaur", ITEMTYPE::MINOTAUR, 1, 5, 3);
+                    monster = ARCHETYPE::MINOTAUR;
                 } else if (rr < 9) {
-                    monster = new Monster("a", "wizard", ITEMTYPE::WIZARD, 1, 5, 5);
+                    monster = ARCHETYPE::WIZARD;
                 } else {
-                    monster = new Monster("a", "floating eye", ITEMTYPE::FLOATINGEYE, 1, 5, 5);
+                    monster = ARCHETYPE::FLOATING_EYE;
                 }
             }
-            items_[std::make_pair(row, col)] = ITEMPTR(monster);
+            return entities_.create(monster);
 
         // item
         } else if (r < 90) {
-            int r = rand() % 100;
+            int r = rng_.uniform(100);
             if (r < 40) {
-                items_[std::make_pair(row, col)] = ITEMPTR(new Potion());
+                return entities_.create(ARCHETYPE::HEALING_POTION);
             } else if (r < 60) {
-                items_[std::make_pair(row, col)] = ITEMPTR(new Key());
+                return entities_.create(ARCHETYPE::KEY);
             } else if (r < 70) {
-                items_[std::make_pair(row, col)] =
-                    ITEMPTR(new Shield("a", "buckler", ITEMTYPE::SHIELD, 0, 1));
+                return entities_.create(ARCHETYPE::BUCKLER);
             } else if (r < 80) {
-                items_[std::make_pair(row, col)] =
-                    ITEMPTR(new Shield("a", "shield", ITEMTYPE::SHIELD, 0, 2));
+                return entities_.create(ARCHETYPE::SHIELD);
             } else if (r < 90) {
-                items_[std::make_pair(row, col)] =
-                ITEMPTR(new Weapon("a", "sword", ITEMTYPE::WEAPON, 0, 1));
+                return entities_.create(ARCHETYPE::SWORD);
             } else {
-                items_[std::make_pair(row, col)] =
-                  ITEMPTR(new Weapon("a", "battleaxe", ITEMTYPE::WEAPON, 0, 2));
+                return entities_.create(ARCHETYPE::BATTLEAXE);
             }
-            return;
 
         // trap
         } else {
-            items_[std::make_pair(row, col)] = ITEMPTR(new Trap());
+            return entities_.create(ARCHETYPE::TRAP);
         }
     }
 }
 
-void World::WorldImpl::addDoors() {
-    World world;
+// Goes through the floor tiles of each row a word at a time, with the walls
+// either side of it to hand as bits.
+void World::WorldImpl::addDoors(int first, int last) {
+    std::size_t words = rowWords();
+    std::uint64_t* floors = &rows_[0];
+    std::uint64_t* above = &rows_[words];
+    std::uint64_t* here = &rows_[2 * words];
+    std::uint64_t* below = &rows_[3 * words];
+    auto wall = [](const std::uint64_t* row, int col) {
+        return (row[col / 64] >> (col % 64)) & 1;
+    };
 
-    for (int row = 1; row < MAP_HEIGHT - 1; row++) {
-        for (int col = 1; col < MAP_WIDTH - 1; col++) {
-            if (map_[row][col]->terrain() != TERRAIN::FLOOR) {
-                continue;
-            }
-            int r = rand() % 100;
-            if (r < 30) {
-                // Check how many walls are adjacent to the door
-                int adjacent = 0;
-                if (map_[row - 1][col]->terrain() == TERRAIN::C_WALL) {
-                    adjacent++;
-                }
-                if (map_[row + 1][col]->terrain() == TERRAIN::C_WALL) {
-                    adjacent++;
-                }
-                if (map_[row][col - 1]->terrain() == TERRAIN::C_WALL) {
-                    adjacent += 3;
+    for (int row = first; row < last; row++) {
+        tiles_.floors().copy(index(row, 0), static_cast<std::size_t>(width_),
+            floors);
+        tiles_.walls().copy(index(row - 1, 0),
+            static_cast<std::size_t>(width_), above);
+        tiles_.walls().copy(index(row, 0), static_cast<std::size_t>(width_),
+            here);
+        tiles_.walls().copy(index(row + 1, 0),
+            static_cast<std::size_t>(width_), below);
+
+        for (std::size_t w = 0; w < words; w++) {
+            for (std::uint64_t bits = floors[w]; bits != 0; bits &= bits - 1) {
+                int col = static_cast<int>(w * 64) + __builtin_ctzll(bits);
+                if (col < 1 || col > width_ - 2) {
+                    continue;
                 }
-                if (map_[row][col + 1]->terrain() == TERRAIN::C_WALL) {
-                    adjacent += 3;
+                int r = rng_.uniform(100);
+                if (r >= 30) {
+                    continue;
                 }
 
                 // Unless there are exactly 2 walls horizontally or
                 // vertically, no door.
+                int adjacent = static_cast<int>(wall(above, col) +
+                    wall(below, col) + 3 * wall(here, col - 1) +
+                    3 * wall(here, col + 1));
                 if (adjacent != 2 && adjacent != 6) {
                     continue;
                 }
 
                 // Now check if any doors already exist next to this door
                 // if so, no door.
-                if (adjacent == 2) {
-                    if (dynamic_cast<Door*>(world.itemAt(row, col - 1)) || dynamic_cast<Door*>(world.itemAt(row, col + 1))) {
-                        continue;
-                     }
+                if (adjacent == 2 && (tiles_.door(index(row, col - 1)) ||
+                tiles_.door(index(row, col + 1)))) {
+                    continue;
                 }
-
-                if (adjacent == 6) {
-                    if (dynamic_cast<Door*>(world.itemAt(row - 1, col)) || dynamic_cast<Door*>(world.itemAt(row + 1, col))) {
-                        continue;
-                     }
+                if (adjacent == 6 && (tiles_.door(index(row - 1, col)) ||
+                tiles_.door(index(row + 1, col)))) {
+                    continue;
                 }
 
-                Door* door = new Door();
-                if (adjacent == 6) {
-                    door->setHorizontal(true);
-                }
-                items_[std::make_pair(row, col)] = ITEMPTR(door);
+                Entity door = entities_.create(ARCHETYPE::DOOR);
+                entities_.doors().find(door)->horizontal = adjacent == 6;
+                place(row, col, door);
+                tiles_.setDoor(index(row, col), true);
             }
         }
     }
@@ -376,138 +1014,380 @@ void World::WorldImpl::addDoors() {
 
 void World::WorldImpl::addExits() {
     std::vector<int> freeCols;
-    for (int i = 1; i < MAP_WIDTH - 1; i++) {
-        if (impl_.map_[1][i]->terrain() == TERRAIN::FLOOR) {
+    for (int i = 1; i < width_ - 1; i++) {
+        if (at(1, i).terrain() == TERRAIN::FLOOR) {
             freeCols.push_back(i);
         }
     }
-    startCol_ = freeCols[rand() % freeCols.size()];
+    startCol_ =
+        freeCols[rng_.uniform(static_cast<std::uint32_t>(freeCols.size()))];
     makeFloor(0, startCol_);
 
     playerRow_ = 0;
     playerCol_ = startCol_;
 
     freeCols.clear();
-    for (int i = 1; i < MAP_WIDTH - 1; i++) {
-        if (impl_.map_[MAP_HEIGHT - 2][i]->terrain() == TERRAIN::FLOOR) {
+    for (int i = 1; i < width_ - 1; i++) {
+        if (at(height_ - 2, i).terrain() == TERRAIN::FLOOR) {
             freeCols.push_back(i);
         }
     }
-    endCol_ = freeCols[rand() % freeCols.size()];
-    makeFloor(MAP_HEIGHT - 1, endCol_);
+    endCol_ =
+        freeCols[rng_.uniform(static_cast<std::uint32_t>(freeCols.size()))];
+    makeFloor(height_ - 1, endCol_);
 }
 
-void World::WorldImpl::addWalls() {
-    //First pass puts a center wall adjacent to any floor or corridor.
-    for (int row = 0; row < MAP_HEIGHT; row++) {
-        for (int col = 0; col < MAP_WIDTH; col++) {
-
-            auto & t = map_[row][col];
+// Walls go on every empty tile next to a floor tile, which is the floor
+// spread one tile in every direction, less the floor itself.  Each row of
+// floor is spread sideways once and kept for the rows above and below it.
+void World::WorldImpl::addWalls(int first, int last) {
+    if (!endless_ && first == 0 && last == height_ &&
+    static_cast<std::size_t>(height_) * width_ <= SMALL_MAP) {
+        addWallsSmall();
+        return;
+    }
 
-            if (t->terrain() != TERRAIN::EMPTY) {
-                continue;
+    std::size_t words = rowWords();
+    std::uint64_t* walls = &rows_[6 * words];
+    auto floors = [&](int row) {
+        return &rows_[static_cast<std::size_t>((row % 3 + 3) % 3) * words];
+    };
+    auto spread = [&](int row) {
+        return &rows_[static_cast<std::size_t>(3 + (row % 3 + 3) % 3) * words];
+    };
+    auto load = [&](int row) {
+        std::uint64_t* in = floors(row);
+        std::uint64_t* out = spread(row);
+        if (row < top_ || row >= bottom_) {
+            std::fill_n(in, words, 0);
+            std::fill_n(out, words, 0);
+            return;
+        }
+        tiles_.floors().copy(index(row, 0), static_cast<std::size_t>(width_),
+            in);
+        for (std::size_t w = 0; w < words; w++) {
+            std::uint64_t bits = in[w] | in[w] << 1 | in[w] >> 1;
+            if (w > 0) {
+                bits |= in[w - 1] >> 63;
             }
+            if (w + 1 < words) {
+                bits |= in[w + 1] << 63;
+            }
+            out[w] = bits;
+        }
+    };
 
-            for (int x = row - 1; x < row + 2; x++) {
-
-                if (x < 0 || x >= MAP_HEIGHT) {
-                    continue;
-                }
-
-                for (int y = col - 1; y < col + 2; y++) {
-
-                    if (y < 0 || y >= MAP_WIDTH) {
-                        continue;
-                    }
-
-                    if (x == row && y == col) {
-                        continue;
-                    }
-
-                    TERRAIN c = map_[x][y]->terrain();
-                    if (c == TERRAIN::FLOOR) {
-                        t->setTerrain(TERRAIN::C_WALL);
-                        t->setPassable(false);
-                        goto end;
-                    }
+    load(first - 1);
+    load(first);
+    for (int row = first; row < last; row++) {
+        load(row + 1);
+        tiles_.walls().copy(index(row, 0), static_cast<std::size_t>(width_),
+            walls);
+        const std::uint64_t* floor = floors(row);
+        const std::uint64_t* above = spread(row - 1);
+        const std::uint64_t* here = spread(row);
+        const std::uint64_t* below = spread(row + 1);
+
+        for (std::size_t w = 0; w < words; w++) {
+            for (std::uint64_t bits = (above[w] | here[w] | below[w]) &
+            ~floor[w] & ~walls[w]; bits != 0; bits &= bits - 1) {
+                int col = static_cast<int>(w * 64) + __builtin_ctzll(bits);
+                if (col >= width_) {
+                    break;
                 }
+                std::size_t i = index(row, col);
+                tiles_.setTerrain(i, TERRAIN::C_WALL);
+                tiles_.setPassable(i, false);
             }
-
-            end: ;
         }
     }
 }
 
-void World::WorldImpl::specializeWalls() {
-
-    // Second pass makes specific wall types as needed.
-    std::map<std::string, TERRAIN> walls = {
-        {"01011010", TERRAIN::C_WALL},
-        {"01011000", TERRAIN::BT_WALL},
-        {"01010010", TERRAIN::RT_WALL},
-        {"01010000", TERRAIN::LR_WALL},
-        {"01001010", TERRAIN::LT_WALL},
-        {"01001000", TERRAIN::LL_WALL},
-        {"01000010", TERRAIN::V_WALL},
-        {"01000000", TERRAIN::V_WALL},
-        {"00011010", TERRAIN::TT_WALL},
-        {"00011000", TERRAIN::H_WALL},
-        {"00010000", TERRAIN::H_WALL},
-        {"00010010", TERRAIN::UR_WALL},
-        {"00001010", TERRAIN::UL_WALL},
-        {"00001000", TERRAIN::H_WALL},
-        {"00000010", TERRAIN::V_WALL},
-        {"00000000", TERRAIN::C_WALL},
-    };
+// The same for a whole map of up to SMALL_MAP tiles, like the classic 15x15
+// one, which fits in four words.  The floor is spread sideways by shifting
+// the whole map one bit, masking off the bits which wrapped to another row,
+// then up and down by shifting it a row.
+void World::WorldImpl::addWallsSmall() {
+    std::size_t tiles = static_cast<std::size_t>(height_) * width_;
+    unsigned width = static_cast<unsigned>(width_);
+    SmallBoard inMap{}, notFirst{}, notLast{}, floor{}, walls{};
+    for (std::size_t i = 0; i < tiles; i++) {
+        inMap[i / 64] |= std::uint64_t{1} << (i % 64);
+    }
+    notFirst = inMap;
+    notLast = inMap;
+    for (std::size_t row = 0; row < static_cast<std::size_t>(height_); row++) {
+        std::size_t i = row * width;
+        notFirst[i / 64] &= ~(std::uint64_t{1} << (i % 64));
+        i += width - 1;
+        notLast[i / 64] &= ~(std::uint64_t{1} << (i % 64));
+    }
+    for (std::size_t w = 0; w < (tiles + 63) / 64; w++) {
+        floor[w] = tiles_.floors().word(w);
+        walls[w] = tiles_.walls().word(w);
+    }
 
-    for (int row = 0; row < MAP_HEIGHT; row++) {
-        for (int col = 0; col < MAP_WIDTH; col++) {
+    SmallBoard sideways = floor | (shiftUp(floor, 1) & notFirst) |
+        (shiftDown(floor, 1) & notLast);
+    SmallBoard spread = sideways | shiftUp(sideways, width) |
+        shiftDown(sideways, width);
+    SmallBoard added = spread & ~floor & ~walls & inMap;
+
+    for (std::size_t w = 0; w < added.size(); w++) {
+        for (std::uint64_t bits = added[w]; bits != 0; bits &= bits - 1) {
+            std::size_t i = w * 64 + static_cast<std::size_t>(
+                __builtin_ctzll(bits));
+            tiles_.setTerrain(i, TERRAIN::C_WALL);
+            tiles_.setPassable(i, false);
+        }
+    }
+}
 
-            auto & t = map_[row][col];
+void World::WorldImpl::specializeWalls(int first, int last) {
+    autotile(first, last, 0, width_);
+}
 
-            if (t->terrain() != TERRAIN::C_WALL) {
-                continue;
+// Gives the walls in rows first to last - 1 and columns left to right - 1
+// the shapes that join them to the walls and doors around them.  Which
+// tiles are walls or doors is worked out a row ahead into edges_, three
+// rows of bits, so each tile is only looked at once; on a map held in
+// tiles_ that is a copy from the wall and door layers.
+void World::WorldImpl::autotile(int first, int last, int left, int right) {
+    std::size_t words = rowWords();
+    std::uint64_t* walls = &rows_[0];
+    std::uint64_t* doors = &rows_[words];
+    auto edges = [&](int row) {
+        return &edges_[static_cast<std::size_t>((row % 3 + 3) % 3) * words];
+    };
+    auto bit = [](const std::uint64_t* row, int col) -> unsigned {
+        return col < 0 ? 0 : (row[col / 64] >> (col % 64)) & 1;
+    };
+    auto mark = [&](int row) {
+        std::uint64_t* edge = edges(row);
+        std::fill_n(edge, words, 0);
+        if (row < top_ || row >= bottom_) {
+            return;
+        }
+        if (chunked_) {
+            for (int col = std::max(left - 1, 0);
+            col < std::min(right + 1, width_); col++) {
+                if (isEdge(row, col)) {
+                    edge[col / 64] |= std::uint64_t{1} << (col % 64);
+                }
             }
+            return;
+        }
+        tiles_.walls().copy(index(row, 0), static_cast<std::size_t>(width_),
+            edge);
+        tiles_.doors().copy(index(row, 0), static_cast<std::size_t>(width_),
+            doors);
+        for (std::size_t w = 0; w < words; w++) {
+            edge[w] |= doors[w];
+        }
+    };
 
-            int count = 7;
-            std::bitset<8> edgeset; // represent the edges as a binary number
-            for (int y = row - 1; y < row + 2; y++) {
+    mark(first - 1);
+    mark(first);
+    for (int row = first; row < last; row++) {
+        mark(row + 1);
+        const std::uint64_t* above = edges(row - 1);
+        const std::uint64_t* here = edges(row);
+        const std::uint64_t* below = edges(row + 1);
+
+        if (chunked_) {
+            std::fill_n(walls, words, 0);
+            for (int col = left; col < right; col++) {
+                if (isWall(at(row, col).terrain())) {
+                    walls[col / 64] |= std::uint64_t{1} << (col % 64);
+                }
+            }
+        } else {
+            tiles_.walls().copy(index(row, 0),
+                static_cast<std::size_t>(width_), walls);
+        }
 
-                if (y < 0 || y > MAP_HEIGHT - 1) {
-                    count -= 3;
+        for (std::size_t w = static_cast<std::size_t>(left) / 64;
+        w < words; w++) {
+            for (std::uint64_t bits = walls[w]; bits != 0; bits &= bits - 1) {
+                int col = static_cast<int>(w * 64) + __builtin_ctzll(bits);
+                if (col < left) {
                     continue;
                 }
+                if (col >= right) {
+                    break;
+                }
 
-                for (int x = col - 1; x < col + 2; x++) {
-                    if (x < 0 || x > MAP_WIDTH - 1) {
-                        count--;
-                        continue;
+                std::uint8_t neighbours = static_cast<std::uint8_t>(
+                    bit(above, col - 1) << 7 | bit(above, col) << 6 |
+                    bit(above, col + 1) << 5 | bit(here, col - 1) << 4 |
+                    bit(here, col + 1) << 3 | bit(below, col - 1) << 2 |
+                    bit(below, col) << 1 | bit(below, col + 1));
+                Tile t = at(row, col);
+                TERRAIN shape = WALL_SHAPES[neighbours];
+                if (shape != t.terrain()) {
+                    t.setTerrain(shape);
+                    if (chunked_) {
+                        chunks_.touch(row, col);
                     }
+                }
+            }
+        }
+    }
+}
 
-                    if (y == row && x == col) {
-                        continue;
-                    }
+bool World::WorldImpl::isEdge(int row, int col) {
+    Tile t = at(row, col);
+    return t.isBlock() || t.door();
+}
 
-                    if (map_[y][x]->isBlock()) {
-                        edgeset.set(count);
-                    }
+std::uint64_t World::WorldImpl::chunkSeed(int chunkRow, int chunkCol) const {
+    return mix(mix(seed_, static_cast<std::uint64_t>(chunkRow)),
+        static_cast<std::uint64_t>(chunkCol));
+}
 
-                    auto item = items_.find(std::make_pair(y, x));
-                    if (item != items_.end() &&
-                    dynamic_cast<Door*>(item->second.get())) {
-                        edgeset.set(count);
-                    }
+// Carves the maze of one chunk into floors_.  The maze covers the chunk and
+// the row and column of walls after it, which are the first row and column
+// of the chunks below and to the right, so neighbouring mazes share walls.
+// Every chunk but the first opens one of the walls between its maze and the
+// one above or to the left, which keeps the map a single perfect maze.
+void World::WorldImpl::carveChunk(int chunkRow, int chunkCol) {
+    int top = chunkRow * CHUNKSIZE;
+    int left = chunkCol * CHUNKSIZE;
+    auto open = [this](int row, int col) {
+        floors_[static_cast<std::size_t>(row - floorsTop_) * 3 * CHUNKSIZE +
+            static_cast<std::size_t>(col - floorsLeft_)] = 1;
+    };
 
-                    count--;
-                }
+    if (chunkRow == 0 && startCol_ / CHUNKSIZE == chunkCol) {
+        open(0, startCol_);
+    }
+    if ((height_ - 1) / CHUNKSIZE == chunkRow &&
+    endCol_ / CHUNKSIZE == chunkCol) {
+        open(height_ - 1, endCol_);
+    }
+
+    int height = std::min(CHUNKSIZE + 1, height_ - top);
+    int width = std::min(CHUNKSIZE + 1, width_ - left);
+    if (height < 3 || width < 3) {
+        return;
+    }
+
+    std::uint64_t seed = chunkSeed(chunkRow, chunkCol);
+    Random carving(mix(seed, 0));
+    carver_.carve(maze_, height, width, carving,
+        [&](int row, int col) { open(top + row, left + col); });
+
+    Random linking(mix(seed, 1));
+    bool north;
+    if (chunkRow == 0 && chunkCol == 0) {
+        return;
+    } else if (chunkRow == 0) {
+        north = false;
+    } else if (chunkCol == 0) {
+        north = true;
+    } else {
+        north = linking.uniform(2) == 0;
+    }
+    if (north) {
+        open(top, left + 1 + 2 * static_cast<int>(linking.uniform(
+            static_cast<std::uint32_t>((width - 1) / 2))));
+    } else {
+        open(top + 1 + 2 * static_cast<int>(linking.uniform(
+            static_cast<std::uint32_t>((height - 1) / 2))), left);
+    }
+}
+
+// Generates a chunk from its maze and the mazes of the chunks around it,
+// which decide its doors and the shapes of the walls along its edges.
+void World::WorldImpl::generateChunk(int chunkRow, int chunkCol,
+TileStore& tiles, ItemGrid& items) {
+    floorsTop_ = (chunkRow - 1) * CHUNKSIZE;
+    floorsLeft_ = (chunkCol - 1) * CHUNKSIZE;
+    std::fill(floors_.begin(), floors_.end(), 0);
+    int chunkRows = (height_ + CHUNKSIZE - 1) / CHUNKSIZE;
+    int chunkCols = (width_ + CHUNKSIZE - 1) / CHUNKSIZE;
+    for (int y = chunkRow - 1; y < chunkRow + 2; y++) {
+        for (int x = chunkCol - 1; x < chunkCol + 2; x++) {
+            if (y >= 0 && y < chunkRows && x >= 0 && x < chunkCols) {
+                carveChunk(y, x);
             }
+        }
+    }
 
-            for (auto& wall: walls) {
-                std::bitset<8> mask(wall.first);
-                if ((edgeset & mask) == mask) {
-                    t->setTerrain(wall.second);
+    rng_.seed(mix(chunkSeed(chunkRow, chunkCol), 2));
+    int top = chunkRow * CHUNKSIZE;
+    int left = chunkCol * CHUNKSIZE;
+    int bottom = std::min(top + CHUNKSIZE, height_);
+    int right = std::min(left + CHUNKSIZE, width_);
+    for (int row = top; row < bottom; row++) {
+        for (int col = left; col < right; col++) {
+            std::size_t i = static_cast<std::size_t>(row - top) * CHUNKSIZE +
+                static_cast<std::size_t>(col - left);
+
+            if (floorAt(row, col)) {
+                tiles.setTerrain(i, TERRAIN::FLOOR);
+                tiles.setPassable(i, true);
+                Entity item;
+                if (int pattern = doorAt(row, col)) {
+                    item = entities_.create(ARCHETYPE::DOOR);
+                    entities_.doors().find(item)->horizontal = pattern == 6;
+                    tiles.setDoor(i, true);
+                } else {
+                    item = newItem(row, col);
+                }
+                if (item != NO_ENTITY) {
+                    entities_.positions().insert(item, Position{row, col});
+                    items.insert(row - top, col - left, item);
                 }
+                continue;
             }
+
+            tiles.setPassable(i, false);
+            tiles.setTerrain(i, WALL_SHAPES[neighbours(row, col, 0, height_,
+            width_, [this](int y, int x) {
+                return !floorAt(y, x) || doorAt(y, x) != 0;
+            })]);
         }
     }
 }
+
+bool World::WorldImpl::floorAt(int row, int col) const {
+    if (row < 0 || row >= height_ || col < 0 || col >= width_) {
+        return false;
+    }
+    return floors_[static_cast<std::size_t>(row - floorsTop_) * 3 * CHUNKSIZE +
+        static_cast<std::size_t>(col - floorsLeft_)] != 0;
+}
+
+// The same rule as addDoors() but with a roll which depends only on where
+// the tile is, so it gives the same answer from any chunk.  Returns 2 for a
+// door between walls above and below, 6 for one between walls either side,
+// and 0 for no door.
+int World::WorldImpl::doorPattern(int row, int col) const {
+    if (row < 1 || row > height_ - 2 || col < 1 || col > width_ - 2 ||
+    !floorAt(row, col)) {
+        return 0;
+    }
+    std::uint64_t roll = mix(seed_, static_cast<std::uint64_t>(row) *
+        static_cast<std::uint64_t>(width_) + static_cast<std::uint64_t>(col));
+    if (roll % 100 >= 30) {
+        return 0;
+    }
+
+    int adjacent = 0;
+    adjacent += !floorAt(row - 1, col);
+    adjacent += !floorAt(row + 1, col);
+    adjacent += 3 * !floorAt(row, col - 1);
+    adjacent += 3 * !floorAt(row, col + 1);
+    return adjacent == 2 || adjacent == 6 ? adjacent : 0;
+}
+
+// A door unless the tile before it along the corridor could have been one.
+int World::WorldImpl::doorAt(int row, int col) const {
+    int pattern = doorPattern(row, col);
+    if ((pattern == 2 && doorPattern(row, col - 1) != 0) ||
+    (pattern == 6 && doorPattern(row - 1, col) != 0)) {
+        return 0;
+    }
+    return pattern;
+}